@@ -0,0 +1,70 @@
+#ifndef BUZZER_H_INCLUDED
+#define BUZZER_H_INCLUDED
+/*
+||
+||  Filename:           Buzzer.h
+||  Title:              Buzzer pattern sequencer
+||  Compiler:           AVR-GCC
+||  Description:
+||  Plays beep patterns stored in PROGMEM in the background.
+||  Timer2 runs in CTC mode: tone steps toggle OC2 (PD7),
+||  rest/on steps drive the pin directly, and the compare
+||  ISR counts elapsed time to advance through the steps.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// The buzzer must sit on OC2 for tone steps
+#define BUZZER_PORT             PORTD
+#define BUZZER_DDR              DDRD
+#define BUZZER_PIN              PD7
+
+// Timer2 prescaler 64: 4 us per count at 16 MHz
+#define BUZZER_PRESCALER        64
+#define BUZZER_COUNTS_PER_MS    (F_CPU / BUZZER_PRESCALER / 1000)
+//-------------------------------------------------//
+
+//----- Tones -------------------------------------//
+#define BUZZER_REST             0x00    // Pin low
+#define BUZZER_ON               0xFF    // Pin high (active buzzer)
+// Square wave on OC2, valid for roughly 500 Hz - 30 kHz
+#define BUZZER_TONE(Hz)         ((uint8_t)(F_CPU / (2UL * BUZZER_PRESCALER * (Hz)) - 1))
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint8_t Tone;               // BUZZER_REST, BUZZER_ON or BUZZER_TONE(Hz)
+    uint16_t Duration;          // Milliseconds
+} BuzzerStep_t;
+
+typedef struct
+{
+    const BuzzerStep_t *Steps;  // PROGMEM array
+    uint8_t Count;
+    uint8_t Repeats;            // Extra passes after the first
+} BuzzerPattern_t;
+
+#define BUZZER_PATTERN(Steps, Repeats)  { Steps, sizeof(Steps) / sizeof(Steps[0]), Repeats }
+//-------------------------------------------------//
+
+//----- Patterns (PROGMEM) ------------------------//
+extern const BuzzerPattern_t Buzzer_Startup;
+extern const BuzzerPattern_t Buzzer_Error;
+extern const BuzzerPattern_t Buzzer_Quick;
+extern const BuzzerPattern_t Buzzer_Success;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Buzzer_Init(void);
+void Buzzer_Play(const BuzzerPattern_t *Pattern);
+void Buzzer_Stop(void);
+uint8_t Buzzer_IsBusy(void);
+//-----------------------------------------------------------------------------//
+#endif
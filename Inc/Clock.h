@@ -0,0 +1,79 @@
+#ifndef CLOCK_H_INCLUDED
+#define CLOCK_H_INCLUDED
+/*
+||
+||  Filename:           Clock.h
+||  Title:              Monotonic clock and timer wheel
+||  Compiler:           AVR-GCC
+||  Description:
+||  Timer0 driven millisecond time base with ISR-safe
+||  snapshot reads, plus a hashed timer wheel so any
+||  number of software deadlines share the same tick.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Number of wheel slots, must be a power of two.
+// Deadlines hash on (expiry & mask), so a slot only
+// holds timers that are due on the same residue.
+#define TIMER_WHEEL_SLOTS       16
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+
+// Timer0: CTC, prescaler 64, 250 counts = exactly 1 ms at 16 MHz
+#define CLOCK_TIMER0_PRESCALER  64
+#define CLOCK_TIMER0_TOP        ((F_CPU / CLOCK_TIMER0_PRESCALER / 1000) - 1)
+#define CLOCK_US_PER_COUNT      (1000000UL * CLOCK_TIMER0_PRESCALER / F_CPU)
+
+// Coarse idle ticks: prescaler 1024, 125 or 250 counts = 8 or 16 ms
+#define CLOCK_IDLE_PRESCALER    1024
+#define CLOCK_IDLE_TOP(Ms)      ((F_CPU / CLOCK_IDLE_PRESCALER) * (Ms) / 1000 - 1)
+#define CLOCK_IDLE_US_PER_COUNT (1000000UL * CLOCK_IDLE_PRESCALER / F_CPU)
+#define CLOCK_TICK_MAX_MS       16
+
+#define CLOCK_SECONDS_PER_DAY   86400UL
+
+#if CLOCK_TIMER0_TOP > 255 || CLOCK_IDLE_TOP(CLOCK_TICK_MAX_MS) > 255
+#error "Timer0 top does not fit 8 bits, adjust the Clock prescalers"
+#endif
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef void (*TimerCallback_t)(void *Arg);
+
+typedef struct Timer_s
+{
+    struct Timer_s *Next;
+    uint32_t Expiry;            // Absolute deadline in ms
+    uint16_t Period;            // 0 = one-shot
+    TimerCallback_t Callback;
+    void *Arg;
+    uint8_t Active;
+} Timer_t;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Clock_Init(void);
+uint32_t Clock_Millis(void);
+uint32_t Clock_Micros(void);
+uint32_t Clock_Seconds(void);
+void Clock_SetSeconds(const uint32_t Seconds);
+uint32_t Clock_TimeToday(const uint8_t Hours, const uint8_t Minutes, const uint8_t Seconds);
+void Clock_SetTickMs(const uint8_t Ms);
+uint8_t Clock_GetTickMs(void);
+
+// Wrap-safe deadline helpers
+#define Clock_Deadline(Ms)      (Clock_Millis() + (uint32_t)(Ms))
+#define Clock_Expired(Deadline) ((int32_t)(Clock_Millis() - (uint32_t)(Deadline)) >= 0)
+
+void Timer_Start(Timer_t *Timer, const uint16_t DelayMs, const uint16_t PeriodMs, TimerCallback_t Callback, void *Arg);
+void Timer_Stop(Timer_t *Timer);
+uint8_t Timer_IsActive(const Timer_t *Timer);
+uint16_t Timer_NextDelay(void);
+void Timer_Service(void);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,60 @@
+#ifndef COMMAND_H_INCLUDED
+#define COMMAND_H_INCLUDED
+/*
+||
+||  Filename:           Command.h
+||  Title:              USART command interface
+||  Compiler:           AVR-GCC
+||  Description:
+||  Line based commands from a host, terminated by CR or LF.
+||  Replies are "OK ..." or "ERR ..." lines; EXPORT answers
+||  with a binary frame (see Frame.h). Commands run as a
+||  coroutine next to the menu flows and use the same store
+||  operations as the keypad.
+||
+||  LIST                    OK <n>, then "<id> <hh:mm:ss>" per record
+||  COUNT                   OK <n>
+||  ABSENT                  OK <n>, then "<id>" per enrolled student not present
+||  FIND <id>               OK <id> <hh:mm:ss> | ERR NOT FOUND
+||  DEL <id>                OK | ERR NOT FOUND
+||  CLOSE                   OK <session> | ERR EMPTY, archives the present list
+||  SESSIONS                OK <n>, then "<session> <hh:mm> <count>", newest first
+||  SESSION <session>       OK <n>, then "<id> <hh:mm:ss>" per record
+||                          | ERR NOT FOUND | ERR CORRUPT
+||  RANGE <from> [to]       OK <n>, then "<id> <hh:mm:ss>" per record at/after
+||                          from and before to, in time order | ERR BAD TIME
+||  EXPORT [since]          Attendance frame of records at/after since
+||  EXPORT SESSION <session>
+||                          Attendance frame of an archived session
+||                          | ERR NOT FOUND | ERR CORRUPT
+||  SYNC [FULL]             Sync frame of changes since the last ACK
+||  ACK <seq>               OK | ERR BAD SEQ, advances the sync cursor
+||  TIME [time]             Set (or read) the clock
+||  IMPORT                  OK READY, then takes a roster frame,
+||                          OK <stored> <rejected> | ERR ...
+||
+||  Times are "hh:mm[:ss]" on today's clock, as the keypad
+||  takes them, or plain seconds. During IMPORT the device
+||  throttles the host with XON/XOFF.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define COMMAND_LINE_SIZE       32
+#define COMMAND_REPLY_SIZE      24
+
+// IMPORT gives up after this long without a byte from the host
+#define COMMAND_IMPORT_TIMEOUT_MS   2000
+// After a failed import, drop input until the line is this quiet
+#define COMMAND_IMPORT_QUIET_MS     50
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Command_Poll(void);
+uint8_t Command_IsBusy(void);
+//-----------------------------------------------------------------------------//
+#endif
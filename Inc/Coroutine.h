@@ -0,0 +1,60 @@
+#ifndef COROUTINE_H_INCLUDED
+#define COROUTINE_H_INCLUDED
+/*
+||
+||  Filename:           Coroutine.h
+||  Title:              Stackless coroutines
+||  Compiler:           AVR-GCC
+||  Description:
+||  Protothread style local continuations built on switch/case.
+||  A coroutine is a function returning CO_RUNNING or CO_DONE;
+||  its only saved state is the line it yielded on, so any value
+||  that must survive a yield lives in a static/global context,
+||  not in a local variable. Do not yield from inside a switch.
+||
+||  Demo:
+||  uint8_t Blink(Co_t *Co) {           static uint32_t Wait;
+||      CO_BEGIN(Co);
+||      while (1) {
+||          LedToggle();
+||          CO_SLEEP(Co, Wait, 500);
+||      }
+||      CO_END(Co);
+||  }
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+
+#include "Clock.h"
+//--------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint16_t Line;              // Resume point, 0 = start
+} Co_t;
+
+#define CO_RUNNING              0
+#define CO_DONE                 1
+//-------------------------------------------------//
+
+//----- Macros ------------------------------------//
+#define CO_INIT(Co)             ((Co)->Line = 0)
+#define CO_BEGIN(Co)            switch ((Co)->Line) { case 0:
+#define CO_END(Co)              } (Co)->Line = 0; return CO_DONE
+
+// Give the CPU back, resume here on the next call
+#define CO_YIELD(Co)            do { (Co)->Line = __LINE__; return CO_RUNNING; case __LINE__:; } while (0)
+
+// Re-evaluate Cond on every call, continue once it holds
+#define CO_WAIT_UNTIL(Co, Cond) do { (Co)->Line = __LINE__; case __LINE__: if (!(Cond)) return CO_RUNNING; } while (0)
+
+// Non-blocking delay; Deadline must be static storage
+#define CO_SLEEP(Co, Deadline, Ms) \
+    do { (Deadline) = Clock_Deadline(Ms); CO_WAIT_UNTIL(Co, Clock_Expired(Deadline)); } while (0)
+
+#define CO_EXIT(Co)             do { (Co)->Line = 0; return CO_DONE; } while (0)
+//-------------------------------------------------//
+#endif
@@ -0,0 +1,61 @@
+#ifndef EEQUEUE_H_INCLUDED
+#define EEQUEUE_H_INCLUDED
+/*
+||
+||  Filename:           EEQueue.h
+||  Title:              EEPROM write-behind queue
+||  Compiler:           AVR-GCC
+||  Description:
+||  Byte writes are queued in RAM and return at once; the
+||  EE_RDY interrupt programs them one at a time, so the CPU
+||  no longer waits 8.5 ms per byte. Writes come out in the
+||  order they were queued, which keeps commit-marker-last
+||  sequences crash safe. Queuing never reads the EEPROM; a
+||  byte that already holds its value is skipped by the
+||  interrupt when its turn comes, at no write cost.
+||
+||  Reads see pending writes. All EEPROM access has to go
+||  through this module: the interrupt owns EEAR whenever
+||  the queue is not empty. A read that misses the queue
+||  holds it, waits for the one write in progress and lets
+||  the queue carry on afterwards, so it never waits for a
+||  whole burst.
+||
+||  EEQueue_Flush() is the durability barrier: it returns once
+||  every queued byte is in the EEPROM. Closing a session
+||  calls it before reporting success; a roster import polls
+||  EEQueue_IsIdle() for the same reason. Writing into a full
+||  queue waits for room, so interrupts must be enabled.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Pending bytes, power of two no larger than 256. The largest
+// burst is a store change with its copy-forwards (about 30).
+#define EEQUEUE_SIZE            32
+#define EEQUEUE_MASK            (EEQUEUE_SIZE - 1)
+
+#if EEQUEUE_SIZE & EEQUEUE_MASK || EEQUEUE_SIZE > 256
+#error "EEQUEUE_SIZE must be a power of two no larger than 256"
+#endif
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+uint8_t EEQueue_ReadByte(const uint16_t Addr);
+uint16_t EEQueue_ReadWord(const uint16_t Addr);
+void EEQueue_ReadBlock(void *Dst, const uint16_t Addr, uint8_t Length);
+
+void EEQueue_WriteByte(const uint16_t Addr, const uint8_t Byte);
+void EEQueue_WriteWord(const uint16_t Addr, const uint16_t Word);
+void EEQueue_WriteBlock(const void *Src, const uint16_t Addr, uint8_t Length);
+
+uint8_t EEQueue_Room(void);
+uint8_t EEQueue_IsIdle(void);
+void EEQueue_Flush(void);
+//-----------------------------------------------------------------------------//
+#endif
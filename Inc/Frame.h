@@ -0,0 +1,53 @@
+#ifndef FRAME_H_INCLUDED
+#define FRAME_H_INCLUDED
+/*
+||
+||  Filename:           Frame.h
+||  Title:              Binary framed transfers
+||  Compiler:           AVR-GCC
+||  Description:
+||  Compact binary frames over the USART transmit ring.
+||  All multi-byte fields are little endian.
+||
+||  Offset  Size    Field
+||  0       2       Start of frame, 0xA5 0x5A
+||  2       1       Frame type
+||  3       1       Schema version of the records
+||  4       2       Record count
+||  6       n       Records
+||  6+n     2       CRC-16/CCITT-FALSE over bytes 2 .. 5+n
+||
+||  CRC: polynomial 0x1021, init 0xFFFF, no reflection,
+||  no final xor ("123456789" -> 0x29B1).
+||
+*/
+
+//----- Headers ------------//
+#include <avr/pgmspace.h>
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define FRAME_SOF0              0xA5
+#define FRAME_SOF1              0x5A
+#define FRAME_HEADER_SIZE       6
+#define FRAME_CRC_INIT          0xFFFF
+
+// Frame types
+#define FRAME_TYPE_ATTENDANCE   0x01
+#define FRAME_TYPE_ROSTER       0x02    // Host to device, see Roster.h
+#define FRAME_TYPE_SYNC         0x03    // Changes since the sync cursor, see Store.h
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+uint16_t Frame_Crc16(uint16_t Crc, const uint8_t *Data, uint16_t Length);
+
+// Non-blocking: return 0 (and queue nothing) until the TX ring has room
+uint8_t Frame_TryBegin(const uint8_t Type, const uint8_t Version, const uint16_t Count);
+uint8_t Frame_TryWrite(const void *Data, const uint8_t Length);
+uint8_t Frame_TryEnd(void);
+uint8_t Frame_TryAbort(void);
+uint8_t Frame_IsReady(void);
+uint8_t Frame_IsOpen(void);
+//-----------------------------------------------------------------------------//
+#endif
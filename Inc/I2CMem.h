@@ -0,0 +1,76 @@
+#ifndef I2CMEM_H_INCLUDED
+#define I2CMEM_H_INCLUDED
+/*
+||
+||  Filename:           I2CMem.h
+||  Title:              24Cxx I2C EEPROM / FRAM driver
+||  Compiler:           AVR-GCC
+||  Description:
+||  External memory on the I2C bus shared with the RTC. PORTC
+||  is the GLCD data bus, so the TWI pins are taken and the
+||  bus is driven in software, open drain: a line is pulled
+||  low through DDR and released to the pull-up resistors.
+||
+||  Writes are split at page boundaries and each page goes
+||  out as one transfer. The chip then programs it on its own
+||  (about 5 ms on an EEPROM, none on FRAM); the next access
+||  polls for the acknowledge instead of waiting a fixed time,
+||  so a write returns as soon as its last page is sent.
+||  Reads set the address once and stream sequentially.
+||
+||  A chip that does not answer reads as erased and drops
+||  writes. So does a bus whose SCL never rises (no chip, no
+||  pull-ups): the clock is given up on after
+||  I2CMEM_STRETCH_US and the bus stays off until the next
+||  I2CMem_Init(), so boot never hangs on it.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Bus lines, on the pins reserved for the RTC
+#define I2CMEM_PORT             PORTD
+#define I2CMEM_DDR              DDRD
+#define I2CMEM_PIN              PIND
+#define I2CMEM_SDA              PD2
+#define I2CMEM_SCL              PD3
+
+// Chip: 24C256 (32 KB, 64-byte pages) with A2..A0 tied low
+#define I2CMEM_ADDRESS          0x50
+#define I2CMEM_SIZE             32768UL
+#define I2CMEM_PAGE_SIZE        64
+
+// Half an SCL period, 5 us = 100 kHz, safe for every 24Cxx
+#define I2CMEM_HALF_PERIOD_US   5
+
+// Acknowledge polls before a write cycle counts as hung. A poll
+// is one address byte, about 100 us at 100 kHz.
+#define I2CMEM_POLL_LIMIT       200
+
+// Longest SCL low time accepted after release. 24Cxx chips do not
+// stretch the clock, so this only ends the wait on a dead bus.
+#define I2CMEM_STRETCH_US       1000
+
+// Up to 2 KB (24C16) the top address bits ride in the device address
+#if I2CMEM_SIZE > 2048
+#define I2CMEM_WORD_ADDRESS     2
+#else
+#define I2CMEM_WORD_ADDRESS     1
+#endif
+
+#if I2CMEM_SIZE > 65536 || I2CMEM_PAGE_SIZE & (I2CMEM_PAGE_SIZE - 1)
+#error "I2CMem takes up to 64 KB with power of two pages"
+#endif
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void I2CMem_Init(void);
+uint8_t I2CMem_Read(void *Dst, const uint16_t Addr, uint16_t Length);
+uint8_t I2CMem_Write(const void *Src, const uint16_t Addr, uint16_t Length);
+uint8_t I2CMem_IsIdle(void);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,56 @@
+#ifndef PAGECACHE_H_INCLUDED
+#define PAGECACHE_H_INCLUDED
+/*
+||
+||  Filename:           PageCache.h
+||  Title:              LRU page cache over a storage backend
+||  Compiler:           AVR-GCC
+||  Description:
+||  Keeps a few aligned pages of one backend (see Storage.h)
+||  in RAM. A miss fetches the whole page with one block read
+||  and replaces the least recently used one, so walking the
+||  records of an archived session costs one I2C transfer per
+||  page instead of one per record, and headers looked up
+||  again are not fetched again.
+||
+||  Writes go straight through to the backend, in order, and
+||  patch any cached copy of the bytes they cover, so reads
+||  never see stale data and commit-mark-last sequences keep
+||  their crash safety.
+||
+||  Only the session archive (Session.c) reads through it:
+||  the present list of Store.h is small enough to live in
+||  RAM and is not paged.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+
+#include "Storage.h"
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#ifndef PAGECACHE_PAGES
+#define PAGECACHE_PAGES         4
+#endif
+#ifndef PAGECACHE_PAGE_SIZE
+#define PAGECACHE_PAGE_SIZE     16      // Bytes, a power of two
+#endif
+
+#if PAGECACHE_PAGE_SIZE < 2 || PAGECACHE_PAGE_SIZE > 128 || PAGECACHE_PAGE_SIZE & (PAGECACHE_PAGE_SIZE - 1)
+#error "PAGECACHE_PAGE_SIZE must be a power of two from 2 to 128"
+#endif
+#if PAGECACHE_PAGES < 1 || PAGECACHE_PAGES > 255
+#error "PAGECACHE_PAGES must be 1 to 255"
+#endif
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void PageCache_Init(const Storage_t *Backend);
+void PageCache_Read(void *Dst, const uint16_t Addr, uint16_t Length);
+void PageCache_Write(const void *Src, const uint16_t Addr, uint16_t Length);
+void PageCache_Invalidate(void);
+void PageCache_Flush(void);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,115 @@
+#ifndef ROSTER_H_INCLUDED
+#define ROSTER_H_INCLUDED
+/*
+||
+||  Filename:           Roster.h
+||  Title:              Enrolled student roster
+||  Compiler:           AVR-GCC
+||  Description:
+||  List of enrolled IDs in the upper EEPROM, loaded from the
+||  host as one roster frame (see Frame.h) of 3-byte packed
+||  IDs. The frame is parsed byte by byte while it arrives;
+||  valid IDs go into the EEPROM write queue (EEQueue.h), so
+||  the 8.5 ms byte writes overlap reception. An import fills
+||  the bank the roster is not using; only when the frame CRC
+||  checks out is that bank's header written, with a newer
+||  sequence number, and the roster switches over. A bad or
+||  cut transfer leaves the old roster in use.
+||
+||  The two banks halve the room: 41 IDs by default, 84 with
+||  the session archive on I2C. ROSTER_CAPACITY may be set
+||  lower with -D; a larger one stops the build.
+||
+||  IDs must arrive in ascending order, so a position is found
+||  by binary search. Presence of enrolled students is one bit
+||  per roster position, kept in step by the store: duplicate
+||  checks are a bit test, and present/absent counts scan a
+||  few dozen bytes.
+||
+||  EEPROM layout at ROSTER_START_ADDR, up to ROSTER_END_ADDR:
+||  0       4 * 2   Bank headers: count (LE), sequence, CRC-8
+||  8       3 * n   Bank 0: packed IDs (LE), ascending
+||  8 + 3n  3 * n   Bank 1, n = ROSTER_CAPACITY
+||
+||  The header with a good CRC, a sane count and the newer
+||  sequence number names the roster in use.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "Session.h"
+#include "Store.h"
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Right after the store ring
+#define ROSTER_START_ADDR       STORE_EEPROM_END
+#define ROSTER_HEADER_SIZE      4
+#define ROSTER_HEADER_ADDR(b)   (ROSTER_START_ADDR + (b) * ROSTER_HEADER_SIZE)
+#define ROSTER_DATA_ADDR        (ROSTER_START_ADDR + 2 * ROSTER_HEADER_SIZE)
+
+// An internal session archive takes the top of the EEPROM
+#if SESSION_STORAGE == STORAGE_INTERNAL
+#define ROSTER_END_ADDR         SESSION_START_ADDR
+#else
+#define ROSTER_END_ADDR         (E2END + 1)
+#endif
+
+// IDs per bank, as many as fit by default
+#define ROSTER_CAPACITY_MAX     ((ROSTER_END_ADDR - ROSTER_DATA_ADDR) / (2 * PACKED_ID_SIZE))
+#ifndef ROSTER_CAPACITY
+#define ROSTER_CAPACITY         ROSTER_CAPACITY_MAX
+#endif
+#define ROSTER_BANK_ADDR(b)     (ROSTER_DATA_ADDR + (b) * ROSTER_CAPACITY * PACKED_ID_SIZE)
+#define ROSTER_SCHEMA_VERSION   1
+#define ROSTER_BITMAP_SIZE      ((ROSTER_CAPACITY + 7) / 8)
+
+#if ROSTER_END_ADDR > E2END + 1
+#error "Roster runs past the EEPROM, lower STORE_EEPROM_END"
+#endif
+#if ROSTER_CAPACITY_MAX < 1
+#error "No EEPROM left for the roster, lower STORE_EEPROM_END or raise SESSION_START_ADDR"
+#endif
+#if ROSTER_CAPACITY < 1 || ROSTER_CAPACITY > ROSTER_CAPACITY_MAX
+#error "ROSTER_CAPACITY does not fit two banks, move the archive to I2C (SESSION_STORAGE) or lower it"
+#endif
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef enum
+{
+    ROSTER_IMPORT_BUSY,
+    ROSTER_IMPORT_DONE,
+    ROSTER_IMPORT_BAD_FRAME,    // Wrong frame type or schema version
+    ROSTER_IMPORT_BAD_CRC,
+    ROSTER_IMPORT_FULL,         // More IDs than ROSTER_CAPACITY
+    ROSTER_IMPORT_UNSORTED      // IDs not in ascending order
+} RosterImport_t;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Roster_Load(void);
+uint16_t Roster_Count(void);
+int16_t Roster_Find(const uint32_t Packed);
+uint32_t Roster_Get(const uint16_t Index);
+
+// Presence by roster position
+void Roster_Refresh(void);
+uint8_t Roster_IsPresent(const uint16_t Index);
+void Roster_SetPresent(const uint16_t Index, const uint8_t Present);
+uint16_t Roster_PresentCount(void);
+int16_t Roster_NextAbsent(const uint16_t From);
+
+// Streaming import: feed received bytes while HasRoom, call Service often
+void Roster_ImportBegin(void);
+uint8_t Roster_ImportHasRoom(void);
+void Roster_ImportFeed(const uint8_t Byte);
+RosterImport_t Roster_ImportService(void);
+void Roster_ImportAbort(void);
+uint16_t Roster_ImportStored(void);
+uint16_t Roster_ImportRejected(void);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,134 @@
+#ifndef SESSION_H_INCLUDED
+#define SESSION_H_INCLUDED
+/*
+||
+||  Filename:           Session.h
+||  Title:              Closed session archive
+||  Compiler:           AVR-GCC
+||  Description:
+||  Sessions closed with Store_CloseSession() are kept apart
+||  from the store ring, on a storage backend (see Storage.h):
+||  the top of the internal EEPROM, or a whole external I2C
+||  chip. A header table says where each one lives: session
+||  ID, start time and a record range in a circular record
+||  area, so the records of one session are read directly,
+||  without going through anything else. RAM only holds the
+||  order of the table; headers and records are read on demand
+||  through a few cached pages (see PageCache.h), so listing a
+||  session from an I2C chip costs one transfer per page.
+||
+||  Sessions are written in order after the newest one. When
+||  the header table or the record area is full, the oldest
+||  sessions are dropped first; their headers are invalidated
+||  before any of their records is overwritten. A header is
+||  committed by its mark byte, written last, so a reset
+||  while archiving leaves the previous sessions intact.
+||
+||  Each header carries a CRC-16 over its session's records
+||  and a CRC-8 over its own fields. Loading checks only the
+||  headers; Session_Verify() reads a session's records back
+||  against their CRC before they are trusted.
+||
+||  Layout at SESSION_START_ADDR on the backend:
+||  0       1       SESSION_MAGIC, written once
+||  1       12 * n  Headers: ID, start (4), first (2), count,
+||                  record CRC (2), check, mark
+||  1+12n   5 * m   Records: packed ID (3), time (2, as Store.h)
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "I2CMem.h"
+#include "Storage.h"
+#include "Store.h"
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Where the archive lives: STORAGE_INTERNAL shares the ATmega32
+// EEPROM with the roster, STORAGE_I2C takes a whole 24Cxx or FRAM
+#ifndef SESSION_STORAGE
+#define SESSION_STORAGE         STORAGE_INTERNAL
+#endif
+
+// Start address and header count can be set with -D as well
+#if SESSION_STORAGE == STORAGE_I2C
+#define SESSION_BACKEND         Storage_I2C
+#ifndef SESSION_START_ADDR
+#define SESSION_START_ADDR      0x0000
+#endif
+#define SESSION_END_ADDR        I2CMEM_SIZE
+#ifndef SESSION_SLOTS
+#define SESSION_SLOTS           64      // Headers, so archived sessions
+#endif
+#else
+#define SESSION_BACKEND         Storage_Internal
+#ifndef SESSION_START_ADDR
+#define SESSION_START_ADDR      0x300   // Above the roster
+#endif
+#define SESSION_END_ADDR        (E2END + 1)
+#ifndef SESSION_SLOTS
+#define SESSION_SLOTS           4
+#endif
+#endif
+
+#define SESSION_MAGIC           0x60    // Changes with the layout
+
+#define SESSION_HEADER_ADDR     (SESSION_START_ADDR + 1)
+#define SESSION_HEADER_SIZE     12
+#define SESSION_HEADER_ID       0
+#define SESSION_HEADER_START    1
+#define SESSION_HEADER_FIRST    5
+#define SESSION_HEADER_COUNT    7
+#define SESSION_HEADER_CRC      8       // CRC-16/CCITT-FALSE of the records, as Frame.h
+#define SESSION_HEADER_CHECK    10      // CRC-8 of the bytes before it
+#define SESSION_HEADER_MARK     11
+
+#define SESSION_MARK_VALID      0xA5
+#define SESSION_MARK_EMPTY      0xFF
+
+#define SESSION_DATA_ADDR       (SESSION_HEADER_ADDR + SESSION_SLOTS * SESSION_HEADER_SIZE)
+#define SESSION_RECORD_SIZE     (PACKED_ID_SIZE + 2)
+#define SESSION_CAPACITY        ((SESSION_END_ADDR - SESSION_DATA_ADDR) / SESSION_RECORD_SIZE)
+
+#if SESSION_CAPACITY < MAX_STUDENTS
+#error "Session record area must hold one full session"
+#endif
+#if SESSION_SLOTS < 1
+#error "SESSION_SLOTS must be at least 1"
+#endif
+
+// Sessions are ordered by 8-bit ID distance from the open one
+#if SESSION_SLOTS > 128
+#error "SESSION_SLOTS must not exceed 128"
+#endif
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint8_t Id;
+    uint8_t Slot;               // Header table entry
+    uint16_t First;             // Record area index of the first record
+    uint8_t Count;
+    uint16_t Crc;               // Over the records
+    uint32_t Start;             // Session epoch, seconds
+} Session_t;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Session_Load(const uint8_t Current);
+uint8_t Session_Count(void);
+const Session_t *Session_Get(const uint8_t Index);
+const Session_t *Session_Find(const uint8_t Id);
+void Session_ReadRecord(const Session_t *Session, const uint8_t Index, uint32_t *Packed, uint32_t *Timestamp);
+uint8_t Session_Verify(const Session_t *Session);
+
+// Archiving: Begin makes room, Append each record, Commit publishes it
+void Session_Begin(const uint8_t Id, const uint32_t Start, const uint8_t Count);
+void Session_Append(const uint8_t Index, const uint32_t Packed, const uint16_t Minute);
+void Session_Commit(void);
+//-----------------------------------------------------------------------------//
+#endif
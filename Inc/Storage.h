@@ -0,0 +1,43 @@
+#ifndef STORAGE_H_INCLUDED
+#define STORAGE_H_INCLUDED
+/*
+||
+||  Filename:           Storage.h
+||  Title:              Storage backends
+||  Compiler:           AVR-GCC
+||  Description:
+||  Byte-addressed non-volatile memory behind one interface,
+||  so a module can be pointed at the internal EEPROM or at an
+||  external I2C chip (see I2CMem.h) by configuration alone.
+||
+||  Write returns once the bytes are handed over; they reach
+||  the memory in the order written, which keeps commit-mark-
+||  last sequences crash safe on every backend. Read sees all
+||  earlier writes. IsIdle is 1 once everything is stored.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define STORAGE_INTERNAL        0       // ATmega32 EEPROM through EEQueue.h
+#define STORAGE_I2C             1       // 24Cxx EEPROM or FRAM through I2CMem.h
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    void (*Init)(void);
+    void (*Read)(void *Dst, const uint16_t Addr, uint16_t Length);
+    void (*Write)(const void *Src, const uint16_t Addr, uint16_t Length);
+    uint8_t (*IsIdle)(void);
+} Storage_t;
+//-------------------------------------------------//
+
+//----- Backends ------------------------------------------------------------//
+extern const Storage_t Storage_Internal;
+extern const Storage_t Storage_I2C;
+//-----------------------------------------------------------------------------//
+#endif
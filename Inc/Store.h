@@ -0,0 +1,316 @@
+#ifndef STORE_H_INCLUDED
+#define STORE_H_INCLUDED
+/*
+||
+||  Filename:           Store.h
+||  Title:              Attendance store
+||  Compiler:           AVR-GCC
+||  Description:
+||  Present-student list kept in RAM and persisted to the
+||  internal EEPROM as an append-only log. The keypad flows
+||  and the USART command interface both go through these
+||  operations.
+||
+||  The log is a ring of slots, each stamped with the next
+||  16-bit sequence number, so writes rotate over every slot
+||  and no address is rewritten more often than the others.
+||  A check-in writes one slot, a removal a tombstone, an ACK
+||  a metadata slot holding the sync cursor. Before the head
+||  can reach a slot still needed (a present student or the
+||  newest metadata), the slot is copied to the head first;
+||  the old copy stays valid until it is overwritten, so a
+||  reset mid-copy loses nothing.
+||
+||  Slots are written in ring order with consecutive numbers,
+||  so seq[i] - seq[0] == i holds exactly up to the head.
+||  Boot finds the head by binary search on that predicate,
+||  then replays the ring from the oldest slot.
+||
+||  A host that acknowledged sequence N gets the changes after
+||  N, in sequence order: adds from the list by the sequence
+||  number of the add, removals from their ring slots. Once
+||  the slot after N has been overwritten, or a session was
+||  closed since, it gets a snapshot of the list instead. Both
+||  walks go by key (sequence number, or time and ID), so the
+||  list and the ring may change while a frame is on the wire.
+||
+||  Records are packed: the ID as its 3-byte offset from
+||  STUDENT_ID_BASE, the time as a 16-bit count of
+||  STORE_TIME_STEP seconds (a minute by default) from the
+||  session epoch. A check-in into an empty store starts
+||  a new session (an epoch slot) when its time does not fit
+||  the current one; times outside the session are clamped.
+||  In RAM the present list is kept as parallel arrays: the
+||  packed IDs alone in one dense array of 24-bit integers,
+||  minutes and sequence numbers in others. Lookups, probes
+||  and scans compare integers over the ID array only; IDs
+||  become text only when Store_RecordID() formats one for
+||  display or export. Store_RecordTime() decodes a time.
+||
+||  The arrays are sorted by time, then packed ID. Check-ins
+||  come in time order and simply append; a record replayed
+||  or converted out of order is moved into place. A time
+||  range (Store_RangeBegin()) is found by binary search on
+||  the minutes and walked in order; the GLCD list, the RANGE
+||  command and EXPORT all read the list through it.
+||
+||  The present list is not paged: it is bounded by
+||  MAX_STUDENTS (STORE_RAM_SIZE bytes), and the hash index,
+||  the sort and the ring replay all work on it in place, so
+||  Store_Range*() and Store_Record*() read RAM. What outgrows
+||  RAM is the session archive, and that is what the page
+||  cache (see PageCache.h) sits in front of.
+||
+||  Store_CloseSession() moves the present list into the
+||  session archive (see Session.h) and empties it with one
+||  clear slot; the next check-in opens a session with the
+||  next ID. A reset between the two is finished on boot.
+||
+||  EEPROM layout (v2):
+||  0       1       STORE_MAGIC, written once
+||  1       9 * n   Slots: seq, packed ID, minute, check, kind
+||
+||  The kind byte is the commit marker: it is cleared before
+||  the slot is rewritten and set last, so a torn slot never
+||  counts as written. The check byte is a CRC-8 over the
+||  rest of the slot; a slot that fails it counts as never
+||  written either. Boot applies a slot only if its sequence
+||  number is the one its position calls for, so nothing from
+||  an older lap is mixed in. That check is all boot does: no
+||  ID is re-validated.
+||
+||  Capacity, time step, ring size and RAM budget can be set
+||  with -D at build time; everything else is derived from
+||  them and checked below. Changing the ring size, the time
+||  step or the archive placement changes the EEPROM layout,
+||  so bump STORE_MAGIC / SESSION_MAGIC with it.
+||
+||  A v1 list (the magic byte held its record count) is
+||  loaded into RAM and written out again as v2.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+// Present students held at once
+#ifndef MAX_STUDENTS
+#define MAX_STUDENTS            40
+#endif
+
+// Seconds per unit of a record's 16-bit time; a session spans
+// 65535 of them
+#ifndef STORE_TIME_STEP
+#define STORE_TIME_STEP         60
+#endif
+
+// End of the ring in the internal EEPROM; the roster follows it
+#ifndef STORE_EEPROM_END
+#define STORE_EEPROM_END        0x200
+#endif
+
+// RAM the present list and its index may take
+#ifndef STORE_RAM_BUDGET
+#define STORE_RAM_BUDGET        512
+#endif
+
+#define EEPROM_START_ADDR       0x00
+
+// IDs: 8 digits, year 20-23, department 001-999 (see
+// validateStudentID()). Valid IDs are 20000001-23999999, so
+// id - base fits 22 bits; the packed width follows the format.
+#define STUDENT_ID_LENGTH       8
+#define STUDENT_ID_BASE         20000000UL
+#define PACKED_ID_SIZE          3
+
+// Removed record in RAM: top bit of the 24-bit packed ID
+#define STORE_RECORD_DEAD       0x800000UL
+
+// Open addressing index over packed IDs, linear probing, kept at
+// most 2/3 full. Entries are record index + 1, so a probe never
+// runs longer than the table.
+#if MAX_STUDENTS <= 21
+#define STORE_INDEX_BITS        5
+#elif MAX_STUDENTS <= 42
+#define STORE_INDEX_BITS        6
+#elif MAX_STUDENTS <= 85
+#define STORE_INDEX_BITS        7
+#else
+#define STORE_INDEX_BITS        8
+#endif
+#define STORE_INDEX_SIZE        (1 << STORE_INDEX_BITS)
+#define STORE_INDEX_MASK        (STORE_INDEX_SIZE - 1)
+
+// Parallel arrays: packed ID, time, slot and add sequence numbers
+#define STORE_RECORD_RAM        (PACKED_ID_SIZE + 2 + 2 + 2)
+#define STORE_RAM_SIZE          (MAX_STUDENTS * STORE_RECORD_RAM + STORE_INDEX_SIZE)
+
+#if MAX_STUDENTS < 1 || MAX_STUDENTS > 170
+#error "MAX_STUDENTS must be 1 to 170"
+#endif
+#if STORE_RAM_SIZE > STORE_RAM_BUDGET
+#error "Present list over STORE_RAM_BUDGET, lower MAX_STUDENTS"
+#endif
+#if STORE_TIME_STEP < 1
+#error "STORE_TIME_STEP must be at least one second"
+#endif
+
+// Binary export record (schema 1): packed ID (3) + timestamp (4)
+#define EXPORT_SCHEMA_VERSION   1
+#define EXPORT_RECORD_SIZE      (PACKED_ID_SIZE + 4)
+
+// Sync record (schema 1): kind (1) + seq (2) + packed ID (3) + timestamp (4)
+#define SYNC_SCHEMA_VERSION     1
+#define SYNC_RECORD_SIZE        (1 + 2 + PACKED_ID_SIZE + 4)
+#define SYNC_KIND_DELTA         0       // First record: seq = upto, timestamp = since
+#define SYNC_KIND_SNAPSHOT      1       // First record: replace everything, seq = upto
+#define SYNC_KIND_ADDED         2
+#define SYNC_KIND_REMOVED       3
+
+// EEPROM layout v2 (see above). The roster above STORE_EEPROM_END
+// is only written by an import and stays out of the ring.
+#define STORE_MAGIC             0xAB
+#define STORE_V1_MAX            20      // v1 kept its count in the magic byte
+#define STORE_RING_ADDR         (EEPROM_START_ADDR + 1)
+#define STORE_ENTRY_SIZE        9
+#define STORE_RING_SLOTS        ((STORE_EEPROM_END - STORE_RING_ADDR) / STORE_ENTRY_SIZE)
+
+// Entry fields. ID and minute form the 5-byte payload; metadata
+// slots reuse it for the sync cursor, the epoch or a clear.
+#define STORE_ENTRY_SEQ         0
+#define STORE_ENTRY_ID          2
+#define STORE_ENTRY_MINUTE      (STORE_ENTRY_ID + PACKED_ID_SIZE)
+#define STORE_ENTRY_CHECK       (STORE_ENTRY_MINUTE + 2)
+#define STORE_ENTRY_KIND        (STORE_ENTRY_CHECK + 1)
+#define STORE_PAYLOAD_SIZE      (STORE_ENTRY_CHECK - STORE_ENTRY_ID)
+
+// CRC-8 (polynomial 0x07) over seq, payload and kind
+#define STORE_CHECK_INIT        0xFF
+
+#define STORE_KIND_END          0xFF    // Erased or being rewritten
+#define STORE_KIND_ADD          0x01
+#define STORE_KIND_REMOVE       0x02
+#define STORE_KIND_KEEP         0x03    // Acknowledged add, copied forward
+#define STORE_KIND_META         0x04    // Sync cursor in the ID field
+#define STORE_KIND_EPOCH        0x05    // Session start: seconds, then session ID
+#define STORE_KIND_CLEAR        0x06    // Session closed: its ID, then the seq it closed at
+
+// Slots ahead of the head that are always free, so a needed slot
+// can be copied before the head reaches it
+#define STORE_RING_WINDOW       2
+
+// Slots beyond present students, metadata and the window. They
+// bound how long a tombstone survives unacknowledged, and how
+// many copies a change costs when the store is nearly full.
+#ifndef STORE_RING_SPARE
+#define STORE_RING_SPARE        12
+#endif
+
+#if STORE_RING_SLOTS < MAX_STUDENTS + 2 + STORE_RING_WINDOW + STORE_RING_SPARE
+#error "Store ring too small for MAX_STUDENTS, raise STORE_EEPROM_END"
+#endif
+// Slot numbers are 8-bit
+#if STORE_RING_SLOTS > 255
+#error "Store ring over 255 slots, lower STORE_EEPROM_END"
+#endif
+
+// Open end of a time range
+#define STORE_TIME_END          0xFFFFFFFFUL
+
+// Export streaming: records per half of the double buffer. A half
+// must fit the USART TX ring in one piece (see Frame_TryWrite()).
+#define STORE_STREAM_RECORDS    4
+
+// Wrap-safe sequence order
+#define STORE_SEQ_AFTER(A, B)   ((int16_t)((uint16_t)(A) - (uint16_t)(B)) > 0)
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint16_t Minute;            // Key of the next record: time,
+    uint32_t Packed;            // then packed ID
+    uint32_t To;                // End, seconds, exclusive
+    uint8_t Done;
+} StoreRange_t;
+
+typedef struct
+{
+    uint16_t Since;             // Host cursor the delta starts after
+    uint16_t Upto;              // Sequence to acknowledge once received
+    uint8_t Full;               // Snapshot instead of delta
+    uint16_t Count;             // Records in the frame, first one included
+    uint16_t Left;              // Records still to deliver
+    uint16_t Next;              // Delta: next sequence number to look at
+    uint8_t Short;              // Changes gone since Begin, zero records padded
+    StoreRange_t Range;         // Snapshot: next record by key
+} StoreSync_t;
+
+typedef struct
+{
+    uint8_t Data[2][STORE_STREAM_RECORDS * EXPORT_RECORD_SIZE];
+    uint8_t Length[2];          // Bytes waiting in each half, 0 = free
+    uint8_t Out;                // Half to drain next
+    uint8_t Short;              // Source ran dry, zero records padded
+    uint16_t Left;              // Records still to deliver
+    uint8_t Archived;           // Source: an archived session, else Range
+    uint8_t Session;            // Its ID
+    uint8_t Next;               // Its next record
+    StoreRange_t Range;
+} StoreStream_t;
+
+typedef enum
+{
+    STORE_OK,
+    STORE_INVALID,
+    STORE_DUPLICATE,
+    STORE_FULL,
+    STORE_NOT_FOUND,
+    STORE_BAD_SEQ
+} StoreStatus_t;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void Store_Load(void);
+uint8_t Store_Count(void);
+uint8_t Store_Slots(void);
+uint8_t Store_IsLive(const uint8_t Index);
+int16_t Store_Find(const char *Id);
+StoreStatus_t Store_Add(const char *Id, const uint32_t Timestamp);
+StoreStatus_t Store_Remove(const char *Id);
+void Store_Service(const uint8_t Compact);
+void Store_RecordID(const uint8_t Index, char *Id);
+uint32_t Store_RecordPacked(const uint8_t Index);
+uint32_t Store_RecordTime(const uint8_t Index);
+StoreStatus_t Store_CloseSession(void);
+uint8_t Store_Session(void);
+
+// Time range: Begin, then Next until it returns -1. Next binary-searches
+// from the last key, so the list may change in between.
+void Store_RangeBegin(StoreRange_t *Range, const uint32_t From, const uint32_t To);
+int16_t Store_RangeNext(StoreRange_t *Range);
+uint8_t Store_RangeCount(const StoreRange_t *Range);
+
+// Export through a double buffer: Begin (a range of the present list)
+// or Session (an archived one) returns the record count; then while
+// Fill returns n > 0, queue n bytes of Data[Out] and call Release.
+// Short is set once padding stood in for records gone meanwhile.
+uint16_t Store_StreamBegin(StoreStream_t *Stream, const uint32_t Since);
+uint16_t Store_StreamSession(StoreStream_t *Stream, const uint8_t Id);
+uint8_t Store_StreamFill(StoreStream_t *Stream);
+void Store_StreamRelease(StoreStream_t *Stream);
+
+// Delta sync: Begin fixes the range and the count, then Next fills
+// one record per call until it returns 0. Short as for streams.
+void Store_SyncBegin(StoreSync_t *Sync, const uint8_t Full);
+uint8_t Store_SyncNext(StoreSync_t *Sync, uint8_t *Out);
+uint16_t Store_SyncCursor(void);
+StoreStatus_t Store_SyncAck(const uint16_t Seq);
+
+uint8_t validateStudentID(const char *id);
+uint32_t packStudentID(const char *id);
+void unpackStudentID(uint32_t packed, char *id);
+//-----------------------------------------------------------------------------//
+#endif
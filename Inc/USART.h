@@ -0,0 +1,82 @@
+#ifndef USART_H_INCLUDED
+#define USART_H_INCLUDED
+/*
+||
+||  Filename:           USART.h
+||  Title:              Interrupt driven USART
+||  Compiler:           AVR-GCC
+||  Description:
+||  Transmit side is a ring buffer drained by the UDRE
+||  interrupt. Enqueueing never waits for the wire, so
+||  exports run at full line rate while the UI stays live.
+||  Receive side is a ring buffer filled by the RXC interrupt,
+||  with optional XON/XOFF flow control for bulk uploads.
+||
+*/
+
+//----- Headers ------------//
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "USART_Settings.h"
+//--------------------------//
+
+//----- Baud rate selection -----------------------//
+// Rounded divisors for normal (16x) and double speed (8x) sampling
+#define USART_UBRR_1X           ((F_CPU + 8UL * BAUD) / (16UL * BAUD) - 1)
+#define USART_UBRR_2X           ((F_CPU + 4UL * BAUD) / (8UL * BAUD) - 1)
+#define USART_RATE_1X           (F_CPU / (16UL * (USART_UBRR_1X + 1)))
+#define USART_RATE_2X           (F_CPU / (8UL * (USART_UBRR_2X + 1)))
+#define USART_ERROR(Rate)       ((Rate) > BAUD ? ((Rate) - BAUD) * 10000UL / BAUD \
+                                               : (BAUD - (Rate)) * 10000UL / BAUD)
+
+// Prefer 16x sampling (more noise margin) unless 8x is strictly closer
+#if USART_UBRR_1X <= 4095 && USART_ERROR(USART_RATE_1X) <= USART_ERROR(USART_RATE_2X)
+#define USART_USE_2X            0
+#define USART_UBRR              USART_UBRR_1X
+#define USART_BAUD_ERROR        USART_ERROR(USART_RATE_1X)
+#elif USART_UBRR_2X <= 4095
+#define USART_USE_2X            1
+#define USART_UBRR              USART_UBRR_2X
+#define USART_BAUD_ERROR        USART_ERROR(USART_RATE_2X)
+#else
+#error "BAUD too low for F_CPU: UBRR does not fit 12 bits"
+#endif
+
+#if USART_BAUD_ERROR > USART_BAUD_TOLERANCE
+#error "BAUD cannot be generated from F_CPU within USART_BAUD_TOLERANCE"
+#endif
+
+#define USART_TX_BUFFER_MASK    (USART_TX_BUFFER_SIZE - 1)
+#define USART_RX_BUFFER_MASK    (USART_RX_BUFFER_SIZE - 1)
+
+#define USART_XON               0x11
+#define USART_XOFF              0x13
+
+#if USART_XOFF_LEVEL >= USART_RX_BUFFER_SIZE || USART_XON_LEVEL >= USART_XOFF_LEVEL
+#error "USART flow control levels must satisfy XON < XOFF < RX buffer size"
+#endif
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void USART_Init(void);
+
+// Non-blocking: return 0 (and queue nothing) when the data does not fit
+uint8_t USART_TryTransmit(const uint8_t Data);
+uint8_t USART_TryWrite(const uint8_t *Data, const uint8_t Length);
+uint8_t USART_TryTransmitString(const char *Str);
+uint8_t USART_TxFree(void);
+uint8_t USART_TxDone(void);
+uint32_t USART_TxCount(void);
+
+// Blocking: wait for ring space, never for the wire
+void USART_Transmit(unsigned char Data);
+void USART_TransmitString(const char *Str);
+
+// Receive: -1 when the ring is empty
+uint8_t USART_RxAvailable(void);
+int16_t USART_Read(void);
+uint8_t USART_RxErrors(void);
+void USART_SetFlowControl(const uint8_t Enable);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,36 @@
+#ifndef USART_SETTINGS_H_INCLUDED
+#define USART_SETTINGS_H_INCLUDED
+/*
+||
+||  Filename:           USART_Settings.h
+||  Title:              USART Settings
+||  Compiler:           AVR-GCC
+||  Description:
+||  Line rate and buffer sizes for the USART driver. The
+||  divisor and U2X mode are derived in USART.h at compile
+||  time; the build fails if BAUD cannot be hit within
+||  USART_BAUD_TOLERANCE at the configured F_CPU.
+||
+*/
+
+//----- Configuration -------------//
+// Line rate. 9600 suits any terminal; fast exports opt in with
+// -DBAUD=250000UL (exact at 16 MHz: 250000, 500000, 1000000).
+#ifndef BAUD
+#define BAUD                    9600UL
+#endif
+
+// Maximum accepted rate error, in 1/10000 (100 = 1.0 %)
+#define USART_BAUD_TOLERANCE    200
+
+// Ring sizes, powers of two no larger than 256
+#define USART_TX_BUFFER_SIZE    64
+#define USART_RX_BUFFER_SIZE    64
+
+// Software flow control: XOFF once this many bytes wait in the
+// RX ring, XON again when the reader has drained it to XON_LEVEL.
+// The gap above XOFF_LEVEL absorbs what the host sends late.
+#define USART_XOFF_LEVEL        32
+#define USART_XON_LEVEL         8
+//---------------------------------//
+#endif
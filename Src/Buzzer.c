@@ -0,0 +1,115 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "Buzzer.h"
+
+//----- Patterns ------------//
+static const BuzzerStep_t Buzzer_StartupSteps[] PROGMEM = {
+    { BUZZER_ON, 200 }, { BUZZER_REST, 200 },
+    { BUZZER_ON, 200 }, { BUZZER_REST, 200 },
+    { BUZZER_ON, 500 }
+};
+static const BuzzerStep_t Buzzer_ErrorSteps[] PROGMEM = {
+    { BUZZER_ON, 750 }
+};
+static const BuzzerStep_t Buzzer_QuickSteps[] PROGMEM = {
+    { BUZZER_ON, 250 }
+};
+static const BuzzerStep_t Buzzer_SuccessSteps[] PROGMEM = {
+    { BUZZER_ON, 250 }, { BUZZER_REST, 250 }
+};
+
+const BuzzerPattern_t Buzzer_Startup PROGMEM = BUZZER_PATTERN(Buzzer_StartupSteps, 0);
+const BuzzerPattern_t Buzzer_Error PROGMEM = BUZZER_PATTERN(Buzzer_ErrorSteps, 0);
+const BuzzerPattern_t Buzzer_Quick PROGMEM = BUZZER_PATTERN(Buzzer_QuickSteps, 0);
+const BuzzerPattern_t Buzzer_Success PROGMEM = BUZZER_PATTERN(Buzzer_SuccessSteps, 1);
+//---------------------------//
+
+//----- Auxiliary data ------//
+static BuzzerPattern_t Buzzer_Pattern;      // RAM copy of the playing pattern
+static volatile uint8_t Buzzer_Index;
+static volatile uint8_t Buzzer_Pass;
+static volatile uint8_t Buzzer_Busy = 0;
+static volatile uint32_t Buzzer_Elapsed;    // Timer2 counts into this step
+static volatile uint32_t Buzzer_Target;
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void Buzzer_Load(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+void Buzzer_Init(void)
+{
+    BUZZER_DDR |= (1 << BUZZER_PIN);
+    BUZZER_PORT &= ~(1 << BUZZER_PIN);
+    TCCR2 = 0;
+    TIMSK |= (1 << OCIE2);
+}
+
+// Starts Pattern (a PROGMEM address), replacing whatever is playing
+void Buzzer_Play(const BuzzerPattern_t *Pattern)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memcpy_P(&Buzzer_Pattern, Pattern, sizeof(Buzzer_Pattern));
+        Buzzer_Index = 0;
+        Buzzer_Pass = 0;
+        Buzzer_Busy = 1;
+        Buzzer_Load();
+    }
+}
+
+void Buzzer_Stop(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR2 = 0;
+        BUZZER_PORT &= ~(1 << BUZZER_PIN);
+        Buzzer_Busy = 0;
+    }
+}
+
+uint8_t Buzzer_IsBusy(void)
+{
+    return Buzzer_Busy;
+}
+
+ISR(TIMER2_COMP_vect)
+{
+    Buzzer_Elapsed += (uint16_t)OCR2 + 1;
+    if (Buzzer_Elapsed < Buzzer_Target) return;
+
+    if (++Buzzer_Index >= Buzzer_Pattern.Count) {
+        Buzzer_Index = 0;
+        if (Buzzer_Pass++ >= Buzzer_Pattern.Repeats) {
+            Buzzer_Stop();
+            return;
+        }
+    }
+    Buzzer_Load();
+}
+
+// Programs Timer2 for the current step; caller holds interrupts off
+static void Buzzer_Load(void)
+{
+    BuzzerStep_t step;
+
+    memcpy_P(&step, &Buzzer_Pattern.Steps[Buzzer_Index], sizeof(step));
+    Buzzer_Elapsed = 0;
+    Buzzer_Target = (uint32_t)step.Duration * BUZZER_COUNTS_PER_MS;
+
+    TCCR2 = 0;
+    TCNT2 = 0;
+    if (step.Tone == BUZZER_REST || step.Tone == BUZZER_ON) {
+        // OC2 disconnected, plain 1 ms ticks
+        if (step.Tone == BUZZER_ON) BUZZER_PORT |= (1 << BUZZER_PIN);
+        else BUZZER_PORT &= ~(1 << BUZZER_PIN);
+        OCR2 = BUZZER_COUNTS_PER_MS - 1;
+        TCCR2 = (1 << WGM21) | (1 << CS22);
+    } else {
+        // Toggle OC2 on every match: f = F_CPU / (2 * 64 * (OCR2 + 1))
+        BUZZER_PORT &= ~(1 << BUZZER_PIN);
+        OCR2 = step.Tone;
+        TCCR2 = (1 << WGM21) | (1 << COM20) | (1 << CS22);
+    }
+}
+//---------------------------//
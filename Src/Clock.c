@@ -0,0 +1,228 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <stddef.h>
+
+#include "Clock.h"
+
+//----- Auxiliary data ------//
+static volatile uint32_t Clock_Ms = 0;       // Milliseconds since boot
+static volatile uint32_t Clock_Sec = 0;      // Seconds since boot (or last set)
+static volatile uint16_t Clock_SubMs = 0;    // Milliseconds into current second
+static volatile uint8_t Clock_TickMs = 1;    // Milliseconds per compare match
+static volatile uint8_t Clock_NextTickMs = 1;
+static volatile uint8_t Clock_UsPerCount = CLOCK_US_PER_COUNT;
+
+static Timer_t *Timer_Wheel[TIMER_WHEEL_SLOTS];
+static uint32_t Timer_Now = 0;               // Last millisecond the wheel processed
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void Timer_Unlink(Timer_t *Timer);
+static void Timer_Link(Timer_t *Timer);
+//---------------------------------------------//
+
+//----- Functions -------------//
+void Clock_Init(void)
+{
+    // CTC mode, prescaler 64, compare every 1 ms
+    TCCR0 = (1 << WGM01) | (1 << CS01) | (1 << CS00);
+    OCR0 = CLOCK_TIMER0_TOP;
+    TCNT0 = 0;
+    TIMSK |= (1 << OCIE0);
+    Timer_Now = 0;
+    sei();
+}
+
+ISR(TIMER0_COMP_vect)
+{
+    uint8_t step = Clock_TickMs;
+
+    Clock_Ms += step;
+    Clock_SubMs += step;
+    if (Clock_SubMs >= 1000) {
+        Clock_SubMs -= 1000;
+        Clock_Sec++;
+    }
+
+    // Retune only right after a match so no partial period is lost
+    if (Clock_NextTickMs != step) {
+        step = Clock_NextTickMs;
+        if (step == 1) {
+            OCR0 = CLOCK_TIMER0_TOP;
+            TCCR0 = (1 << WGM01) | (1 << CS01) | (1 << CS00);
+            Clock_UsPerCount = CLOCK_US_PER_COUNT;
+        } else {
+            OCR0 = CLOCK_IDLE_TOP(step);
+            TCCR0 = (1 << WGM01) | (1 << CS02) | (1 << CS00);
+            Clock_UsPerCount = CLOCK_IDLE_US_PER_COUNT;
+        }
+        Clock_TickMs = step;
+    }
+}
+
+uint32_t Clock_Millis(void)
+{
+    uint32_t ms;
+
+    // 32-bit reads take four instructions, block the ISR meanwhile
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = Clock_Ms;
+    }
+    return ms;
+}
+
+uint32_t Clock_Micros(void)
+{
+    uint32_t ms;
+    uint8_t count;
+    uint8_t pending;
+    uint8_t step;
+    uint8_t usPerCount;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = Clock_Ms;
+        count = TCNT0;
+        pending = TIFR & (1 << OCF0);
+        step = Clock_TickMs;
+        usPerCount = Clock_UsPerCount;
+    }
+    // Compare matched after we blocked the ISR: the tick is owed
+    if (pending && count < OCR0) ms += step;
+
+    return ms * 1000UL + (uint32_t)count * usPerCount;
+}
+
+uint32_t Clock_Seconds(void)
+{
+    uint32_t sec;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        sec = Clock_Sec;
+    }
+    return sec;
+}
+
+void Clock_SetSeconds(const uint32_t Seconds)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Clock_Sec = Seconds;
+        Clock_SubMs = 0;
+    }
+}
+
+// A time of day as Clock_Seconds() reads it on the current day, so
+// anything typed as hh:mm compares with today's timestamps
+uint32_t Clock_TimeToday(const uint8_t Hours, const uint8_t Minutes, const uint8_t Seconds)
+{
+    return Clock_Seconds() / CLOCK_SECONDS_PER_DAY * CLOCK_SECONDS_PER_DAY
+            + Hours * 3600UL + Minutes * 60UL + Seconds;
+}
+
+// Requests 1, 8 or 16 ms per interrupt; takes effect at the next match.
+// Longer ticks let SLEEP_MODE_IDLE last longer between wake-ups.
+void Clock_SetTickMs(const uint8_t Ms)
+{
+    if (Ms >= CLOCK_TICK_MAX_MS) Clock_NextTickMs = CLOCK_TICK_MAX_MS;
+    else if (Ms >= 8) Clock_NextTickMs = 8;
+    else Clock_NextTickMs = 1;
+}
+
+uint8_t Clock_GetTickMs(void)
+{
+    return Clock_TickMs;
+}
+
+void Timer_Start(Timer_t *Timer, const uint16_t DelayMs, const uint16_t PeriodMs, TimerCallback_t Callback, void *Arg)
+{
+    if (Timer->Active) Timer_Unlink(Timer);
+
+    Timer->Callback = Callback;
+    Timer->Arg = Arg;
+    Timer->Period = PeriodMs;
+    // Never arm in the past: the wheel only visits each ms once
+    Timer->Expiry = Clock_Millis() + (DelayMs ? DelayMs : 1);
+    if ((int32_t)(Timer->Expiry - Timer_Now) <= 0) Timer->Expiry = Timer_Now + 1;
+    Timer_Link(Timer);
+}
+
+void Timer_Stop(Timer_t *Timer)
+{
+    if (Timer->Active) Timer_Unlink(Timer);
+}
+
+uint8_t Timer_IsActive(const Timer_t *Timer)
+{
+    return Timer->Active;
+}
+
+// Milliseconds until the earliest armed timer, 0xFFFF when none
+uint16_t Timer_NextDelay(void)
+{
+    uint32_t now = Clock_Millis();
+    uint32_t best = 0xFFFF;
+
+    for (uint8_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+        for (Timer_t *timer = Timer_Wheel[slot]; timer; timer = timer->Next) {
+            int32_t delta = (int32_t)(timer->Expiry - now);
+            if (delta <= 0) return 0;
+            if ((uint32_t)delta < best) best = delta;
+        }
+    }
+    return (uint16_t)best;
+}
+
+void Timer_Service(void)
+{
+    uint32_t now = Clock_Millis();
+
+    // Catch up one slot per elapsed millisecond
+    while (Timer_Now != now) {
+        Timer_Now++;
+        uint8_t slot = Timer_Now & TIMER_WHEEL_MASK;
+        Timer_t **link = &Timer_Wheel[slot];
+
+        while (*link) {
+            Timer_t *timer = *link;
+            if (timer->Expiry != Timer_Now) {
+                link = &timer->Next;
+                continue;
+            }
+
+            *link = timer->Next;
+            timer->Active = 0;
+            if (timer->Period) {
+                timer->Expiry += timer->Period;
+                Timer_Link(timer);
+            }
+            timer->Callback(timer->Arg);
+
+            // Callback may have re-armed or stopped timers in this slot
+            link = &Timer_Wheel[slot];
+        }
+    }
+}
+
+static void Timer_Link(Timer_t *Timer)
+{
+    uint8_t slot = Timer->Expiry & TIMER_WHEEL_MASK;
+
+    Timer->Next = Timer_Wheel[slot];
+    Timer_Wheel[slot] = Timer;
+    Timer->Active = 1;
+}
+
+static void Timer_Unlink(Timer_t *Timer)
+{
+    Timer_t **link = &Timer_Wheel[Timer->Expiry & TIMER_WHEEL_MASK];
+
+    while (*link) {
+        if (*link == Timer) {
+            *link = Timer->Next;
+            break;
+        }
+        link = &(*link)->Next;
+    }
+    Timer->Next = NULL;
+    Timer->Active = 0;
+}
+//---------------------------//
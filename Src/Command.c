@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Command.h"
+#include "Coroutine.h"
+#include "Frame.h"
+#include "Roster.h"
+#include "Session.h"
+#include "Store.h"
+#include "USART.h"
+
+#if STORE_STREAM_RECORDS * EXPORT_RECORD_SIZE >= USART_TX_BUFFER_SIZE
+#error "Half the export stream buffer must fit the USART TX ring"
+#endif
+
+//----- Auxiliary data ------//
+static char Command_Line[COMMAND_LINE_SIZE];
+static uint8_t Command_Length = 0;
+static uint8_t Command_Overflow = 0;
+static uint8_t Command_Running = 0;
+
+// Coroutine state, must survive yields
+static Co_t Command_Co;
+static const char *Command_Arg;
+static char Command_Reply[COMMAND_REPLY_SIZE];
+static uint8_t Command_Record[SYNC_RECORD_SIZE];  // Largest record
+static uint8_t Command_Index;
+static uint16_t Command_Count;
+static int16_t Command_Absent;
+static uint32_t Command_Since;
+static uint32_t Command_Deadline;
+static RosterImport_t Command_Status;
+static StoreSync_t Command_Sync;
+static StoreStream_t Command_Stream;
+static StoreRange_t Command_Range;
+static Session_t Command_Session;
+
+// Queues Command_Reply as one line, yielding while the TX ring is full
+#define COMMAND_REPLY(Co) CO_WAIT_UNTIL(Co, USART_TryTransmitString(Command_Reply))
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t Command_Execute(void);
+static const char *Command_Match(const char *Name);
+static uint8_t Command_ParseID(const char *Arg);
+static const Session_t *Command_ParseSession(const char *Arg);
+static uint8_t Command_ParseTime(const char *Arg, uint32_t *Seconds);
+static void Command_FormatRecord(const uint32_t Packed, const uint32_t Timestamp);
+static RosterImport_t Command_Import(void);
+static uint8_t Command_Discard(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Call once per main loop pass
+void Command_Poll(void)
+{
+    int16_t c;
+
+    if (Command_Running) {
+        if (Command_Execute() == CO_DONE) Command_Running = 0;
+        return;
+    }
+
+    while ((c = USART_Read()) >= 0) {
+        if (c == '\r' || c == '\n') {
+            if (!Command_Length) continue;
+            Command_Line[Command_Length] = '\0';
+            Command_Length = 0;
+            CO_INIT(&Command_Co);
+            Command_Running = 1;
+            if (Command_Execute() == CO_DONE) Command_Running = 0;
+            return;
+        }
+        if (Command_Length < COMMAND_LINE_SIZE - 1) {
+            if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+            Command_Line[Command_Length++] = c;
+        } else {
+            Command_Overflow = 1;
+        }
+    }
+}
+
+// Set while a command is replying; binary frames must not interleave
+uint8_t Command_IsBusy(void)
+{
+    return Command_Running;
+}
+
+static uint8_t Command_Execute(void)
+{
+    Co_t *co = &Command_Co;
+
+    CO_BEGIN(co);
+    // Let a frame already on the wire (menu export) finish first
+    CO_WAIT_UNTIL(co, !Frame_IsOpen());
+
+    if (Command_Overflow) {
+        Command_Overflow = 0;
+        strcpy(Command_Reply, "ERR TOO LONG");
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("LIST"))) {
+        // By key like RANGE: a check-in while a reply waits shifts the slots
+        Store_RangeBegin(&Command_Range, 0, STORE_TIME_END);
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Store_RangeCount(&Command_Range));
+        COMMAND_REPLY(co);
+        for (;;) {
+            int16_t index = Store_RangeNext(&Command_Range);
+
+            if (index < 0) break;
+            Command_Reply[0] = '\0';
+            Command_FormatRecord(Store_RecordPacked(index), Store_RecordTime(index));
+            COMMAND_REPLY(co);
+        }
+    }
+    else if ((Command_Arg = Command_Match("RANGE"))) {
+        char *to = strchr(Command_Arg, ' ');
+        uint32_t from, until = STORE_TIME_END;
+
+        if (to) *to++ = '\0';
+        if (!Command_ParseTime(Command_Arg, &from) || (to && !Command_ParseTime(to, &until))) {
+            strcpy(Command_Reply, "ERR BAD TIME");
+            COMMAND_REPLY(co);
+            CO_EXIT(co);
+        }
+
+        // The range resumes by key, so check-ins meanwhile do not upset it
+        Store_RangeBegin(&Command_Range, from, until);
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Store_RangeCount(&Command_Range));
+        COMMAND_REPLY(co);
+        for (;;) {
+            int16_t index = Store_RangeNext(&Command_Range);
+
+            if (index < 0) break;
+            Command_Reply[0] = '\0';
+            Command_FormatRecord(Store_RecordPacked(index), Store_RecordTime(index));
+            COMMAND_REPLY(co);
+        }
+    }
+    else if ((Command_Arg = Command_Match("ABSENT"))) {
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Roster_Count() - Roster_PresentCount());
+        COMMAND_REPLY(co);
+        for (Command_Count = 0; (Command_Absent = Roster_NextAbsent(Command_Count)) >= 0;
+                Command_Count = Command_Absent + 1) {
+            unpackStudentID(Roster_Get(Command_Absent), Command_Reply);
+            COMMAND_REPLY(co);
+        }
+    }
+    else if ((Command_Arg = Command_Match("COUNT"))) {
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Store_Count());
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("FIND"))) {
+        int16_t index = Command_ParseID(Command_Arg) ? Store_Find(Command_Arg) : -1;
+        if (index >= 0) {
+            strcpy(Command_Reply, "OK ");
+            Command_FormatRecord(Store_RecordPacked(index), Store_RecordTime(index));
+        } else {
+            strcpy(Command_Reply, "ERR NOT FOUND");
+        }
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("DEL"))) {
+        if (Command_ParseID(Command_Arg) && Store_Remove(Command_Arg) == STORE_OK) {
+            strcpy(Command_Reply, "OK");
+        } else {
+            strcpy(Command_Reply, "ERR NOT FOUND");
+        }
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("CLOSE"))) {
+        if (Store_CloseSession() == STORE_OK) {
+            snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Store_Session());
+        } else {
+            strcpy(Command_Reply, "ERR EMPTY");
+        }
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("SESSIONS"))) {
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Session_Count());
+        COMMAND_REPLY(co);
+        for (Command_Index = 0; Command_Index < Session_Count(); Command_Index++) {
+            Command_Session = *Session_Get(Command_Index);
+            snprintf(Command_Reply, sizeof(Command_Reply), "%u %02u:%02u %u", Command_Session.Id,
+                    (uint8_t)((Command_Session.Start / 3600) % 24),
+                    (uint8_t)((Command_Session.Start / 60) % 60), Command_Session.Count);
+            COMMAND_REPLY(co);
+        }
+    }
+    else if ((Command_Arg = Command_Match("SESSION"))) {
+        const Session_t *session = Command_ParseSession(Command_Arg);
+
+        if (!session) {
+            strcpy(Command_Reply, "ERR NOT FOUND");
+            COMMAND_REPLY(co);
+            CO_EXIT(co);
+        }
+
+        if (!Session_Verify(session)) {
+            strcpy(Command_Reply, "ERR CORRUPT");
+            COMMAND_REPLY(co);
+            CO_EXIT(co);
+        }
+
+        // A copy: the table may move while replies wait for the TX ring
+        Command_Session = *session;
+        snprintf(Command_Reply, sizeof(Command_Reply), "OK %u", Command_Session.Count);
+        COMMAND_REPLY(co);
+        for (Command_Index = 0; Command_Index < Command_Session.Count; Command_Index++) {
+            uint32_t packed, timestamp;
+
+            Session_ReadRecord(&Command_Session, Command_Index, &packed, &timestamp);
+            Command_Reply[0] = '\0';
+            Command_FormatRecord(packed, timestamp);
+            COMMAND_REPLY(co);
+        }
+    }
+    else if ((Command_Arg = Command_Match("EXPORT"))) {
+        const Session_t *session = NULL;
+
+        if (strncmp(Command_Arg, "SESSION", 7) == 0) {
+            session = Command_ParseSession(&Command_Arg[7]);
+            if (!session || !Session_Verify(session)) {
+                strcpy(Command_Reply, session ? "ERR CORRUPT" : "ERR NOT FOUND");
+                COMMAND_REPLY(co);
+                CO_EXIT(co);
+            }
+            Command_Session = *session;
+        } else {
+            Command_Since = 0;
+            if (*Command_Arg && !Command_ParseTime(Command_Arg, &Command_Since)) {
+                strcpy(Command_Reply, "ERR BAD TIME");
+                COMMAND_REPLY(co);
+                CO_EXIT(co);
+            }
+        }
+
+        // Records come from the time-ordered list or the archive through
+        // a small double buffer: one half fills while the other drains.
+        // Counted once the header fits, so the count cannot go stale.
+        Command_Index = session != NULL;
+        CO_WAIT_UNTIL(co, Frame_IsReady());
+        if (Command_Index) Command_Count = Store_StreamSession(&Command_Stream, Command_Session.Id);
+        else Command_Count = Store_StreamBegin(&Command_Stream, Command_Since);
+        CO_WAIT_UNTIL(co, Frame_TryBegin(FRAME_TYPE_ATTENDANCE, EXPORT_SCHEMA_VERSION, Command_Count));
+        while (Store_StreamFill(&Command_Stream)) {
+            CO_WAIT_UNTIL(co, Frame_TryWrite(Command_Stream.Data[Command_Stream.Out],
+                    Command_Stream.Length[Command_Stream.Out]));
+            Store_StreamRelease(&Command_Stream);
+        }
+        // Records removed meanwhile went out as padding: the host drops it
+        if (Command_Stream.Short) {
+            CO_WAIT_UNTIL(co, Frame_TryAbort());
+        } else {
+            CO_WAIT_UNTIL(co, Frame_TryEnd());
+        }
+    }
+    else if ((Command_Arg = Command_Match("SYNC"))) {
+        if (*Command_Arg && strcmp(Command_Arg, "FULL") != 0) {
+            strcpy(Command_Reply, "ERR UNKNOWN");
+            COMMAND_REPLY(co);
+            CO_EXIT(co);
+        }
+
+        Command_Count = *Command_Arg != '\0';
+        CO_WAIT_UNTIL(co, Frame_IsReady());
+        Store_SyncBegin(&Command_Sync, Command_Count);
+        CO_WAIT_UNTIL(co, Frame_TryBegin(FRAME_TYPE_SYNC, SYNC_SCHEMA_VERSION, Command_Sync.Count));
+        while (Store_SyncNext(&Command_Sync, Command_Record)) {
+            CO_WAIT_UNTIL(co, Frame_TryWrite(Command_Record, SYNC_RECORD_SIZE));
+        }
+        // A change lost meanwhile went out as padding: the host drops it
+        if (Command_Sync.Short) {
+            CO_WAIT_UNTIL(co, Frame_TryAbort());
+        } else {
+            CO_WAIT_UNTIL(co, Frame_TryEnd());
+        }
+    }
+    else if ((Command_Arg = Command_Match("ACK"))) {
+        char *end;
+        uint32_t seq = strtoul(Command_Arg, &end, 10);
+
+        if (end != Command_Arg && *end == '\0' && seq <= 0xFFFF && Store_SyncAck(seq) == STORE_OK) {
+            strcpy(Command_Reply, "OK");
+        } else {
+            strcpy(Command_Reply, "ERR BAD SEQ");
+        }
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("TIME"))) {
+        uint32_t seconds;
+        if (!*Command_Arg) {
+            seconds = Clock_Seconds();
+            snprintf(Command_Reply, sizeof(Command_Reply), "OK %02u:%02u:%02u",
+                    (uint8_t)((seconds / 3600) % 24), (uint8_t)((seconds / 60) % 60), (uint8_t)(seconds % 60));
+        } else if (Command_ParseTime(Command_Arg, &seconds)) {
+            Clock_SetSeconds(seconds);
+            strcpy(Command_Reply, "OK");
+        } else {
+            strcpy(Command_Reply, "ERR BAD TIME");
+        }
+        COMMAND_REPLY(co);
+    }
+    else if ((Command_Arg = Command_Match("IMPORT"))) {
+        Roster_ImportBegin();
+        strcpy(Command_Reply, "OK READY");
+        COMMAND_REPLY(co);
+
+        USART_SetFlowControl(1);
+        Command_Deadline = Clock_Deadline(COMMAND_IMPORT_TIMEOUT_MS);
+        CO_WAIT_UNTIL(co, (Command_Status = Command_Import()) != ROSTER_IMPORT_BUSY
+                || Clock_Expired(Command_Deadline));
+        USART_SetFlowControl(0);
+
+        if (Command_Status == ROSTER_IMPORT_DONE) {
+            snprintf(Command_Reply, sizeof(Command_Reply), "OK %u %u",
+                    Roster_ImportStored(), Roster_ImportRejected());
+            COMMAND_REPLY(co);
+            CO_EXIT(co);
+        }
+
+        if (Command_Status == ROSTER_IMPORT_BUSY) {
+            Roster_ImportAbort();
+            strcpy(Command_Reply, "ERR TIMEOUT");
+        } else if (Command_Status == ROSTER_IMPORT_FULL) {
+            strcpy(Command_Reply, "ERR FULL");
+        } else if (Command_Status == ROSTER_IMPORT_BAD_CRC) {
+            strcpy(Command_Reply, "ERR CRC");
+        } else if (Command_Status == ROSTER_IMPORT_UNSORTED) {
+            strcpy(Command_Reply, "ERR ORDER");
+        } else {
+            strcpy(Command_Reply, "ERR BAD FRAME");
+        }
+        // The rest of a rejected frame must not reach the line parser
+        Command_Deadline = Clock_Deadline(COMMAND_IMPORT_QUIET_MS);
+        CO_WAIT_UNTIL(co, Command_Discard());
+        COMMAND_REPLY(co);
+    }
+    else {
+        strcpy(Command_Reply, "ERR UNKNOWN");
+        COMMAND_REPLY(co);
+    }
+    CO_END(co);
+}
+
+// Argument string if the line is Name [args], NULL otherwise
+static const char *Command_Match(const char *Name)
+{
+    uint8_t length = strlen(Name);
+
+    if (strncmp(Command_Line, Name, length) != 0) return NULL;
+    if (Command_Line[length] == '\0') return &Command_Line[length];
+    if (Command_Line[length] != ' ') return NULL;
+
+    const char *arg = &Command_Line[length];
+    while (*arg == ' ') arg++;
+    return arg;
+}
+
+static uint8_t Command_ParseID(const char *Arg)
+{
+    return strlen(Arg) == STUDENT_ID_LENGTH && validateStudentID(Arg);
+}
+
+// Archived session named by a decimal ID, NULL if there is none
+static const Session_t *Command_ParseSession(const char *Arg)
+{
+    char *end;
+    uint32_t id;
+
+    while (*Arg == ' ') Arg++;
+    id = strtoul(Arg, &end, 10);
+    if (end == Arg || *end != '\0' || id > 0xFF) return NULL;
+    return Session_Find(id);
+}
+
+static uint8_t Command_ParseTime(const char *Arg, uint32_t *Seconds)
+{
+    char *end;
+    uint32_t value = strtoul(Arg, &end, 10);
+
+    if (end == Arg) return 0;
+    if (*end == '\0') {
+        *Seconds = value;
+        return 1;
+    }
+
+    // hh:mm[:ss]
+    uint32_t minutes, secs = 0;
+    if (*end != ':' || value > 23) return 0;
+    Arg = end + 1;
+    minutes = strtoul(Arg, &end, 10);
+    if (end == Arg || minutes > 59) return 0;
+    if (*end == ':') {
+        Arg = end + 1;
+        secs = strtoul(Arg, &end, 10);
+        if (end == Arg || secs > 59) return 0;
+    }
+    if (*end != '\0') return 0;
+
+    *Seconds = Clock_TimeToday(value, minutes, secs);
+    return 1;
+}
+
+// Appends "<id> <hh:mm:ss>" to Command_Reply
+static void Command_FormatRecord(const uint32_t Packed, const uint32_t Timestamp)
+{
+    uint8_t length = strlen(Command_Reply);
+    char id[STUDENT_ID_LENGTH + 1];
+
+    unpackStudentID(Packed, id);
+    snprintf(&Command_Reply[length], sizeof(Command_Reply) - length, "%s %02u:%02u:%02u",
+            id, (uint8_t)((Timestamp / 3600) % 24),
+            (uint8_t)((Timestamp / 60) % 60), (uint8_t)(Timestamp % 60));
+}
+
+// Moves received bytes into the roster import, returns its status
+static RosterImport_t Command_Import(void)
+{
+    int16_t c;
+
+    while (Roster_ImportHasRoom() && (c = USART_Read()) >= 0) {
+        Roster_ImportFeed(c);
+        Command_Deadline = Clock_Deadline(COMMAND_IMPORT_TIMEOUT_MS);
+    }
+    return Roster_ImportService();
+}
+
+// 1 once nothing arrived for COMMAND_IMPORT_QUIET_MS
+static uint8_t Command_Discard(void)
+{
+    while (USART_Read() >= 0) {
+        Command_Deadline = Clock_Deadline(COMMAND_IMPORT_QUIET_MS);
+    }
+    return Clock_Expired(Command_Deadline);
+}
+//---------------------------//
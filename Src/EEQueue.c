@@ -0,0 +1,135 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "EEQueue.h"
+
+//----- Auxiliary data ------//
+static uint16_t EEQueue_Addr[EEQUEUE_SIZE];
+static uint8_t EEQueue_Data[EEQUEUE_SIZE];
+static volatile uint8_t EEQueue_Head = 0;    // Next free entry, main code only
+static volatile uint8_t EEQueue_Tail = 0;    // Next entry to program, ISR only
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t EEQueue_Pending(const uint16_t Addr, uint8_t *Byte);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Newest queued value of Addr, else the EEPROM contents. Only a read
+// that has to go to the EEPROM waits, and for the running write only:
+// the queue is held until the read is done, then resumed.
+uint8_t EEQueue_ReadByte(const uint16_t Addr)
+{
+    uint8_t byte;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (EEQueue_Pending(Addr, &byte)) return byte;
+        // The ISR must not start the next byte behind the running one
+        EECR &= ~(1 << EERIE);
+    }
+    // At most one write cycle (8.5 ms), with interrupts on
+    while (EECR & (1 << EEWE));
+    EEAR = Addr;
+    EECR |= (1 << EERE);
+    byte = EEDR;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (EEQueue_Head != EEQueue_Tail) EECR |= (1 << EERIE);
+    }
+    return byte;
+}
+
+uint16_t EEQueue_ReadWord(const uint16_t Addr)
+{
+    return EEQueue_ReadByte(Addr) | ((uint16_t)EEQueue_ReadByte(Addr + 1) << 8);
+}
+
+void EEQueue_ReadBlock(void *Dst, const uint16_t Addr, uint8_t Length)
+{
+    uint8_t *dst = Dst;
+
+    for (uint16_t addr = Addr; Length; Length--) {
+        *dst++ = EEQueue_ReadByte(addr++);
+    }
+}
+
+// Queues Byte for Addr without touching the EEPROM; the ISR skips it
+// if the cell already holds it. Waits only while the queue is full.
+void EEQueue_WriteByte(const uint16_t Addr, const uint8_t Byte)
+{
+    uint8_t head = EEQueue_Head;
+
+    while (((head + 1) & EEQUEUE_MASK) == EEQueue_Tail);
+    EEQueue_Addr[head] = Addr;
+    EEQueue_Data[head] = Byte;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        EEQueue_Head = (head + 1) & EEQUEUE_MASK;
+        EECR |= (1 << EERIE);
+    }
+}
+
+void EEQueue_WriteWord(const uint16_t Addr, const uint16_t Word)
+{
+    EEQueue_WriteByte(Addr, Word & 0xFF);
+    EEQueue_WriteByte(Addr + 1, Word >> 8);
+}
+
+void EEQueue_WriteBlock(const void *Src, const uint16_t Addr, uint8_t Length)
+{
+    const uint8_t *src = Src;
+
+    for (uint16_t addr = Addr; Length; Length--) {
+        EEQueue_WriteByte(addr++, *src++);
+    }
+}
+
+// Bytes that can be queued without waiting
+uint8_t EEQueue_Room(void)
+{
+    return (EEQueue_Tail - EEQueue_Head - 1) & EEQUEUE_MASK;
+}
+
+// 1 once every queued byte has been programmed
+uint8_t EEQueue_IsIdle(void)
+{
+    return EEQueue_Head == EEQueue_Tail && !(EECR & (1 << EEWE));
+}
+
+// Blocks until every queued byte is in the EEPROM, up to 8.5 ms a byte
+void EEQueue_Flush(void)
+{
+    while (!EEQueue_IsIdle());
+}
+
+// Fires while EERIE is set and no write is running
+ISR(EE_RDY_vect)
+{
+    uint8_t tail = EEQueue_Tail;
+
+    if (tail == EEQueue_Head) {
+        EECR &= ~(1 << EERIE);
+        return;
+    }
+    EEAR = EEQueue_Addr[tail];
+    EECR |= (1 << EERE);
+    if (EEDR != EEQueue_Data[tail]) {
+        EEDR = EEQueue_Data[tail];
+        // EEWE must follow EEMWE within four cycles
+        EECR |= (1 << EEMWE);
+        EECR |= (1 << EEWE);
+    }
+    EEQueue_Tail = (tail + 1) & EEQUEUE_MASK;
+}
+
+// Caller holds interrupts off
+static uint8_t EEQueue_Pending(const uint16_t Addr, uint8_t *Byte)
+{
+    for (uint8_t i = EEQueue_Head; i != EEQueue_Tail; ) {
+        i = (i - 1) & EEQUEUE_MASK;
+        if (EEQueue_Addr[i] == Addr) {
+            *Byte = EEQueue_Data[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+//---------------------------//
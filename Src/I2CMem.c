@@ -0,0 +1,200 @@
+#include <string.h>
+#include <util/delay.h>
+
+#include "I2CMem.h"
+
+//----- Auxiliary data ------//
+// Open drain: DDR set pulls the line low, cleared lets it float high
+#define I2CMEM_LOW(Line)        (I2CMEM_DDR |= (1 << (Line)))
+#define I2CMEM_HIGH(Line)       (I2CMEM_DDR &= ~(1 << (Line)))
+#define I2CMEM_READ(Line)       (I2CMEM_PIN & (1 << (Line)))
+#define I2CMEM_DELAY()          _delay_us(I2CMEM_HALF_PERIOD_US)
+
+#if I2CMEM_WORD_ADDRESS == 2
+#define I2CMEM_DEVICE(Addr)     (I2CMEM_ADDRESS)
+#else
+#define I2CMEM_DEVICE(Addr)     (I2CMEM_ADDRESS | (((Addr) >> 8) & 0x07))
+#endif
+
+static uint8_t I2CMem_Stuck = 0;             // SCL never rose, bus given up
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void I2CMem_Start(void);
+static void I2CMem_Stop(void);
+static void I2CMem_ClockHigh(void);
+static uint8_t I2CMem_WriteByte(const uint8_t Byte);
+static uint8_t I2CMem_ReadByte(const uint8_t Ack);
+static uint8_t I2CMem_Select(const uint16_t Addr);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Both lines released; PORT stays 0 so DDR alone drives them
+void I2CMem_Init(void)
+{
+    I2CMem_Stuck = 0;
+    I2CMEM_HIGH(I2CMEM_SDA);
+    I2CMEM_HIGH(I2CMEM_SCL);
+    I2CMEM_PORT &= ~((1 << I2CMEM_SDA) | (1 << I2CMEM_SCL));
+}
+
+// Sequential read; a chip that does not answer reads as erased.
+// Returns 0 in that case.
+uint8_t I2CMem_Read(void *Dst, const uint16_t Addr, uint16_t Length)
+{
+    uint8_t *dst = Dst;
+
+    if (!Length) return 1;
+    if (I2CMem_Select(Addr)) {
+        // Repeated start, the chip keeps the address just set
+        I2CMem_Start();
+        I2CMem_WriteByte((I2CMEM_DEVICE(Addr) << 1) | 1);
+        for (uint16_t i = 0; i < Length; i++) {
+            dst[i] = I2CMem_ReadByte(i + 1 < Length);
+        }
+        I2CMem_Stop();
+        if (!I2CMem_Stuck) return 1;
+    }
+
+    memset(Dst, 0xFF, Length);
+    return 0;
+}
+
+// One transfer per page touched; 0 if the chip stopped answering
+uint8_t I2CMem_Write(const void *Src, const uint16_t Addr, uint16_t Length)
+{
+    const uint8_t *src = Src;
+    uint16_t addr = Addr;
+
+    while (Length) {
+        // A page write wraps inside its page, so never cross one
+        uint8_t chunk = I2CMEM_PAGE_SIZE - (addr & (I2CMEM_PAGE_SIZE - 1));
+        if (chunk > Length) chunk = Length;
+
+        if (!I2CMem_Select(addr)) return 0;
+        for (uint8_t i = 0; i < chunk; i++) {
+            I2CMem_WriteByte(*src++);
+        }
+        I2CMem_Stop();
+        if (I2CMem_Stuck) return 0;
+
+        addr += chunk;
+        Length -= chunk;
+    }
+    return 1;
+}
+
+// 1 once the chip acknowledges, i.e. its write cycle is over. A dead
+// bus has nothing in flight.
+uint8_t I2CMem_IsIdle(void)
+{
+    uint8_t ack;
+
+    if (I2CMem_Stuck) return 1;
+    I2CMem_Start();
+    ack = I2CMem_WriteByte(I2CMEM_DEVICE(0) << 1);
+    I2CMem_Stop();
+    return ack;
+}
+
+// SDA falls while SCL is high
+static void I2CMem_Start(void)
+{
+    I2CMEM_HIGH(I2CMEM_SDA);
+    I2CMem_ClockHigh();
+    I2CMEM_DELAY();
+    I2CMEM_LOW(I2CMEM_SDA);
+    I2CMEM_DELAY();
+    I2CMEM_LOW(I2CMEM_SCL);
+}
+
+// SDA rises while SCL is high
+static void I2CMem_Stop(void)
+{
+    I2CMEM_LOW(I2CMEM_SDA);
+    I2CMEM_DELAY();
+    I2CMem_ClockHigh();
+    I2CMEM_DELAY();
+    I2CMEM_HIGH(I2CMEM_SDA);
+    I2CMEM_DELAY();
+}
+
+// Releases SCL and waits out clock stretching, at most
+// I2CMEM_STRETCH_US; a line that stays low marks the bus stuck
+static void I2CMem_ClockHigh(void)
+{
+    I2CMEM_HIGH(I2CMEM_SCL);
+    for (uint16_t us = 0; !I2CMEM_READ(I2CMEM_SCL); us++) {
+        if (I2CMem_Stuck || us >= I2CMEM_STRETCH_US) {
+            I2CMem_Stuck = 1;
+            return;
+        }
+        _delay_us(1);
+    }
+}
+
+// MSB first; returns 1 if the byte was acknowledged
+static uint8_t I2CMem_WriteByte(const uint8_t Byte)
+{
+    uint8_t ack;
+
+    for (uint8_t mask = 0x80; mask; mask >>= 1) {
+        if (Byte & mask) I2CMEM_HIGH(I2CMEM_SDA);
+        else I2CMEM_LOW(I2CMEM_SDA);
+        I2CMEM_DELAY();
+        I2CMem_ClockHigh();
+        I2CMEM_DELAY();
+        I2CMEM_LOW(I2CMEM_SCL);
+    }
+
+    I2CMEM_HIGH(I2CMEM_SDA);
+    I2CMEM_DELAY();
+    I2CMem_ClockHigh();
+    I2CMEM_DELAY();
+    // A floating SDA on a dead bus is no acknowledge
+    ack = !I2CMEM_READ(I2CMEM_SDA) && !I2CMem_Stuck;
+    I2CMEM_LOW(I2CMEM_SCL);
+    return ack;
+}
+
+// Ack asks for another byte, the last one is not acknowledged
+static uint8_t I2CMem_ReadByte(const uint8_t Ack)
+{
+    uint8_t byte = 0;
+
+    I2CMEM_HIGH(I2CMEM_SDA);
+    for (uint8_t i = 0; i < 8; i++) {
+        I2CMEM_DELAY();
+        I2CMem_ClockHigh();
+        I2CMEM_DELAY();
+        byte = (byte << 1) | (I2CMEM_READ(I2CMEM_SDA) ? 1 : 0);
+        I2CMEM_LOW(I2CMEM_SCL);
+    }
+
+    if (Ack) I2CMEM_LOW(I2CMEM_SDA);
+    I2CMEM_DELAY();
+    I2CMem_ClockHigh();
+    I2CMEM_DELAY();
+    I2CMEM_LOW(I2CMEM_SCL);
+    I2CMEM_HIGH(I2CMEM_SDA);
+    return byte;
+}
+
+// Start, device address and word address. A chip still programming
+// the previous page does not acknowledge, so this is also the wait.
+static uint8_t I2CMem_Select(const uint16_t Addr)
+{
+    if (I2CMem_Stuck) return 0;
+    for (uint8_t poll = 0; ; poll++) {
+        I2CMem_Start();
+        if (I2CMem_WriteByte(I2CMEM_DEVICE(Addr) << 1)) break;
+        I2CMem_Stop();
+        if (I2CMem_Stuck || poll >= I2CMEM_POLL_LIMIT) return 0;
+    }
+#if I2CMEM_WORD_ADDRESS == 2
+    I2CMem_WriteByte(Addr >> 8);
+#endif
+    I2CMem_WriteByte(Addr & 0xFF);
+    return 1;
+}
+//---------------------------//
@@ -0,0 +1,99 @@
+#include <string.h>
+
+#include "PageCache.h"
+
+//----- Auxiliary data ------//
+static const Storage_t *PageCache_Backend;
+static uint8_t PageCache_Data[PAGECACHE_PAGES][PAGECACHE_PAGE_SIZE];
+static uint16_t PageCache_Tag[PAGECACHE_PAGES];      // Page number per buffer
+static uint8_t PageCache_Order[PAGECACHE_PAGES];     // Buffers, most recent first
+
+// Past the last page of a 64 KB memory
+#define PAGECACHE_NONE          0xFFFF
+#define PAGECACHE_OFFSET(Addr)  ((Addr) & (PAGECACHE_PAGE_SIZE - 1))
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t PageCache_Fetch(const uint16_t Page);
+//---------------------------------------------//
+
+//----- Functions -------------//
+void PageCache_Init(const Storage_t *Backend)
+{
+    PageCache_Backend = Backend;
+    PageCache_Invalidate();
+}
+
+// Pages touched by the range are fetched on a miss
+void PageCache_Read(void *Dst, const uint16_t Addr, uint16_t Length)
+{
+    uint8_t *dst = Dst;
+    uint16_t addr = Addr;
+
+    while (Length) {
+        uint8_t offset = PAGECACHE_OFFSET(addr);
+        uint8_t chunk = PAGECACHE_PAGE_SIZE - offset;
+        if (chunk > Length) chunk = Length;
+
+        memcpy(dst, &PageCache_Data[PageCache_Fetch(addr / PAGECACHE_PAGE_SIZE)][offset], chunk);
+        dst += chunk;
+        addr += chunk;
+        Length -= chunk;
+    }
+}
+
+// Write-through; cached pages are patched, not fetched
+void PageCache_Write(const void *Src, const uint16_t Addr, uint16_t Length)
+{
+    const uint8_t *src = Src;
+    uint16_t addr = Addr;
+
+    PageCache_Backend->Write(Src, Addr, Length);
+    while (Length) {
+        uint8_t offset = PAGECACHE_OFFSET(addr);
+        uint8_t chunk = PAGECACHE_PAGE_SIZE - offset;
+        if (chunk > Length) chunk = Length;
+
+        for (uint8_t i = 0; i < PAGECACHE_PAGES; i++) {
+            if (PageCache_Tag[i] == addr / PAGECACHE_PAGE_SIZE) {
+                memcpy(&PageCache_Data[i][offset], src, chunk);
+            }
+        }
+        src += chunk;
+        addr += chunk;
+        Length -= chunk;
+    }
+}
+
+// Forgets every page, e.g. once the memory was changed behind the cache
+void PageCache_Invalidate(void)
+{
+    for (uint8_t i = 0; i < PAGECACHE_PAGES; i++) {
+        PageCache_Tag[i] = PAGECACHE_NONE;
+        PageCache_Order[i] = i;
+    }
+}
+
+// Returns once the backend has stored every write
+void PageCache_Flush(void)
+{
+    while (!PageCache_Backend->IsIdle());
+}
+
+// Buffer holding Page, now the most recent; a miss reuses the least recent
+static uint8_t PageCache_Fetch(const uint16_t Page)
+{
+    uint8_t pos, buffer;
+
+    for (pos = 0; pos < PAGECACHE_PAGES - 1 && PageCache_Tag[PageCache_Order[pos]] != Page; pos++);
+    buffer = PageCache_Order[pos];
+    if (PageCache_Tag[buffer] != Page) {
+        PageCache_Backend->Read(PageCache_Data[buffer], Page * PAGECACHE_PAGE_SIZE, PAGECACHE_PAGE_SIZE);
+        PageCache_Tag[buffer] = Page;
+    }
+
+    memmove(&PageCache_Order[1], &PageCache_Order[0], pos);
+    PageCache_Order[0] = buffer;
+    return buffer;
+}
+//---------------------------//
@@ -0,0 +1,328 @@
+#include <string.h>
+#include <util/crc16.h>
+
+#include "EEQueue.h"
+#include "Frame.h"
+#include "Roster.h"
+
+//----- Auxiliary data ------//
+enum
+{
+    ROSTER_WAIT_SOF0,
+    ROSTER_WAIT_SOF1,
+    ROSTER_HEADER,
+    ROSTER_RECORDS,
+    ROSTER_CRC,
+    ROSTER_COMPLETE,
+    ROSTER_COMMIT,
+    ROSTER_IDLE
+};
+
+static uint16_t Roster_Size = 0;             // Committed entries
+static uint8_t Roster_Bank = 0;              // Bank in use
+static uint8_t Roster_Seq = 0;               // Its header's sequence number
+static uint8_t Roster_Present[ROSTER_BITMAP_SIZE];
+
+static uint8_t Roster_State = ROSTER_IDLE;
+static RosterImport_t Roster_Status = ROSTER_IMPORT_DONE;
+static uint8_t Roster_Field[4];              // Header, record or CRC bytes so far
+static uint8_t Roster_FieldIndex;
+static uint16_t Roster_Crc;
+static uint16_t Roster_Expected;
+static uint16_t Roster_Received;
+static uint16_t Roster_Stored;
+static uint16_t Roster_Rejected;
+static uint16_t Roster_WriteAddr;            // Where the next valid ID goes
+static uint32_t Roster_Last;                 // Last stored ID, for the order check
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t Roster_ReadHeader(const uint8_t Bank, uint16_t *Count, uint8_t *Seq);
+static uint8_t Roster_Check(const uint8_t *Header);
+static void Roster_TakeByte(const uint8_t Byte);
+static void Roster_Fail(const RosterImport_t Status);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Call after Store_Load(), presence is taken from the store
+void Roster_Load(void)
+{
+    uint16_t count[2];
+    uint8_t seq[2];
+    uint8_t valid = 0;
+
+    for (uint8_t bank = 0; bank < 2; bank++) {
+        if (Roster_ReadHeader(bank, &count[bank], &seq[bank])) valid |= 1 << bank;
+    }
+    // Both good: the newer one, sequence numbers wrap
+    if (valid == 3) Roster_Bank = (int8_t)(seq[1] - seq[0]) > 0;
+    else Roster_Bank = valid == 2;
+
+    if (valid) {
+        Roster_Size = count[Roster_Bank];
+        Roster_Seq = seq[Roster_Bank];
+    } else {
+        // Erased or never imported
+        Roster_Size = 0;
+        Roster_Seq = 0;
+    }
+    Roster_Refresh();
+}
+
+uint16_t Roster_Count(void)
+{
+    return Roster_Size;
+}
+
+// Roster position of Packed, -1 if not enrolled
+int16_t Roster_Find(const uint32_t Packed)
+{
+    uint16_t lo = 0;
+    uint16_t hi = Roster_Size;
+
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint32_t packed = Roster_Get(mid);
+
+        if (packed == Packed) return mid;
+        if (packed < Packed) lo = mid + 1;
+        else hi = mid;
+    }
+    return -1;
+}
+
+uint32_t Roster_Get(const uint16_t Index)
+{
+    uint8_t id[PACKED_ID_SIZE];
+
+    EEQueue_ReadBlock(id, ROSTER_BANK_ADDR(Roster_Bank) + Index * PACKED_ID_SIZE, PACKED_ID_SIZE);
+    return id[0] | ((uint32_t)id[1] << 8) | ((uint32_t)id[2] << 16);
+}
+
+// Rebuilds the bitmap from the store, after boot or an import
+void Roster_Refresh(void)
+{
+    memset(Roster_Present, 0, sizeof(Roster_Present));
+    for (uint8_t i = 0; i < Store_Slots(); i++) {
+        int16_t index;
+
+        if (!Store_IsLive(i)) continue;
+        index = Roster_Find(Store_RecordPacked(i));
+        if (index >= 0) Roster_SetPresent(index, 1);
+    }
+}
+
+uint8_t Roster_IsPresent(const uint16_t Index)
+{
+    return (Roster_Present[Index >> 3] >> (Index & 7)) & 1;
+}
+
+void Roster_SetPresent(const uint16_t Index, const uint8_t Present)
+{
+    if (Present) Roster_Present[Index >> 3] |= 1 << (Index & 7);
+    else Roster_Present[Index >> 3] &= ~(1 << (Index & 7));
+}
+
+// Bits past Roster_Size are never set, so whole bytes can be counted
+uint16_t Roster_PresentCount(void)
+{
+    uint16_t count = 0;
+
+    for (uint8_t i = 0; i < ROSTER_BITMAP_SIZE; i++) {
+        // Clears the lowest set bit per pass
+        for (uint8_t bits = Roster_Present[i]; bits; bits &= bits - 1) count++;
+    }
+    return count;
+}
+
+// First absent position at or after From, -1 when there is none
+int16_t Roster_NextAbsent(const uint16_t From)
+{
+    for (uint16_t index = From; index < Roster_Size; index++) {
+        // Skip eight present students at a time
+        if ((index & 7) == 0 && Roster_Present[index >> 3] == 0xFF) {
+            index += 7;
+            continue;
+        }
+        if (!Roster_IsPresent(index)) return index;
+    }
+    return -1;
+}
+
+void Roster_ImportBegin(void)
+{
+    Roster_State = ROSTER_WAIT_SOF0;
+    Roster_Status = ROSTER_IMPORT_BUSY;
+    Roster_WriteAddr = ROSTER_BANK_ADDR(!Roster_Bank);
+    Roster_Stored = Roster_Rejected = 0;
+}
+
+// Room for one more whole record in the write queue
+uint8_t Roster_ImportHasRoom(void)
+{
+    return EEQueue_Room() >= PACKED_ID_SIZE;
+}
+
+void Roster_ImportFeed(const uint8_t Byte)
+{
+    switch (Roster_State) {
+    case ROSTER_WAIT_SOF0:
+        // Skips the rest of the command line (LF) and line noise
+        if (Byte == FRAME_SOF0) Roster_State = ROSTER_WAIT_SOF1;
+        break;
+
+    case ROSTER_WAIT_SOF1:
+        if (Byte == FRAME_SOF1) {
+            Roster_State = ROSTER_HEADER;
+            Roster_FieldIndex = 0;
+            Roster_Crc = FRAME_CRC_INIT;
+        } else if (Byte != FRAME_SOF0) {
+            Roster_State = ROSTER_WAIT_SOF0;
+        }
+        break;
+
+    case ROSTER_HEADER:
+        Roster_TakeByte(Byte);
+        if (Roster_FieldIndex < 4) break;
+
+        if (Roster_Field[0] != FRAME_TYPE_ROSTER || Roster_Field[1] != ROSTER_SCHEMA_VERSION) {
+            Roster_Fail(ROSTER_IMPORT_BAD_FRAME);
+            break;
+        }
+        Roster_Expected = Roster_Field[2] | ((uint16_t)Roster_Field[3] << 8);
+        if (Roster_Expected > ROSTER_CAPACITY) {
+            Roster_Fail(ROSTER_IMPORT_FULL);
+            break;
+        }
+
+        // The spare bank is overwritten from now on: void its header
+        // first, in case it still holds an older roster
+        EEQueue_WriteWord(ROSTER_HEADER_ADDR(!Roster_Bank), 0xFFFF);
+        Roster_Received = 0;
+        Roster_FieldIndex = 0;
+        Roster_State = Roster_Expected ? ROSTER_RECORDS : ROSTER_CRC;
+        break;
+
+    case ROSTER_RECORDS:
+        Roster_TakeByte(Byte);
+        if (Roster_FieldIndex < PACKED_ID_SIZE) break;
+        Roster_FieldIndex = 0;
+
+        {
+            char id[STUDENT_ID_LENGTH + 1];
+            uint32_t packed = Roster_Field[0] | ((uint32_t)Roster_Field[1] << 8)
+                    | ((uint32_t)Roster_Field[2] << 16);
+
+            unpackStudentID(packed, id);
+            if (validateStudentID(id)) {
+                // Binary search needs ascending IDs; duplicates fail too
+                if (Roster_Stored && packed <= Roster_Last) {
+                    Roster_Fail(ROSTER_IMPORT_UNSORTED);
+                    break;
+                }
+                Roster_Last = packed;
+                // Re-importing the same roster costs no write cycles
+                EEQueue_WriteBlock(Roster_Field, Roster_WriteAddr, PACKED_ID_SIZE);
+                Roster_WriteAddr += PACKED_ID_SIZE;
+                Roster_Stored++;
+            } else {
+                Roster_Rejected++;
+            }
+        }
+        if (++Roster_Received == Roster_Expected) Roster_State = ROSTER_CRC;
+        break;
+
+    case ROSTER_CRC:
+        // Received CRC bytes are not part of the CRC
+        Roster_Field[Roster_FieldIndex++] = Byte;
+        if (Roster_FieldIndex < 2) break;
+
+        if ((Roster_Field[0] | ((uint16_t)Roster_Field[1] << 8)) == Roster_Crc) {
+            Roster_State = ROSTER_COMPLETE;
+        } else {
+            Roster_Fail(ROSTER_IMPORT_BAD_CRC);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Queues the spare bank's header behind its IDs once the frame
+// checked out and switches to it; reports done only when all of it
+// is in the EEPROM
+RosterImport_t Roster_ImportService(void)
+{
+    if (Roster_State == ROSTER_COMPLETE) {
+        uint8_t header[ROSTER_HEADER_SIZE] = {
+            Roster_Stored & 0xFF, Roster_Stored >> 8, Roster_Seq + 1
+        };
+
+        // Check byte last: a torn header fails its CRC
+        header[ROSTER_HEADER_SIZE - 1] = Roster_Check(header);
+        EEQueue_WriteBlock(header, ROSTER_HEADER_ADDR(!Roster_Bank), ROSTER_HEADER_SIZE);
+        Roster_Bank = !Roster_Bank;
+        Roster_Seq++;
+        Roster_Size = Roster_Stored;
+        Roster_Refresh();
+        Roster_State = ROSTER_COMMIT;
+    }
+    if (Roster_State == ROSTER_COMMIT && EEQueue_IsIdle()) {
+        Roster_State = ROSTER_IDLE;
+        Roster_Status = ROSTER_IMPORT_DONE;
+    }
+    return Roster_Status;
+}
+
+// Stops an import (host went quiet). IDs already queued still get
+// written, but only into the spare bank, whose header stays void.
+void Roster_ImportAbort(void)
+{
+    Roster_State = ROSTER_IDLE;
+}
+
+uint16_t Roster_ImportStored(void)
+{
+    return Roster_Stored;
+}
+
+uint16_t Roster_ImportRejected(void)
+{
+    return Roster_Rejected;
+}
+
+// 1 if Bank's header has a good check byte and a count that fits
+static uint8_t Roster_ReadHeader(const uint8_t Bank, uint16_t *Count, uint8_t *Seq)
+{
+    uint8_t header[ROSTER_HEADER_SIZE];
+
+    EEQueue_ReadBlock(header, ROSTER_HEADER_ADDR(Bank), ROSTER_HEADER_SIZE);
+    *Count = header[0] | ((uint16_t)header[1] << 8);
+    *Seq = header[2];
+    return header[ROSTER_HEADER_SIZE - 1] == Roster_Check(header) && *Count <= ROSTER_CAPACITY;
+}
+
+// CRC-8 over count and sequence
+static uint8_t Roster_Check(const uint8_t *Header)
+{
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < ROSTER_HEADER_SIZE - 1; i++) {
+        crc = _crc8_ccitt_update(crc, Header[i]);
+    }
+    return crc;
+}
+
+static void Roster_TakeByte(const uint8_t Byte)
+{
+    Roster_Field[Roster_FieldIndex++] = Byte;
+    Roster_Crc = Frame_Crc16(Roster_Crc, &Byte, 1);
+}
+
+static void Roster_Fail(const RosterImport_t Status)
+{
+    Roster_Status = Status;
+    Roster_ImportAbort();
+}
+//---------------------------//
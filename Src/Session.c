@@ -0,0 +1,224 @@
+#include <string.h>
+#include <util/crc16.h>
+
+#include "Frame.h"
+#include "PageCache.h"
+#include "Session.h"
+
+//----- Auxiliary data ------//
+static uint8_t Session_Order[SESSION_SLOTS];     // Header slots, newest first
+static uint8_t Session_Total = 0;
+static uint16_t Session_Records = 0;             // Records of all archived sessions
+static Session_t Session_Open;                   // Being archived
+static Session_t Session_Found;                  // Returned by Get and Find
+
+#define SESSION_HEADER(Slot)    (SESSION_HEADER_ADDR + (uint16_t)(Slot) * SESSION_HEADER_SIZE)
+#define SESSION_RECORD(Index)   (SESSION_DATA_ADDR + (uint16_t)(Index) * SESSION_RECORD_SIZE)
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t Session_ReadHeader(const uint8_t Slot, Session_t *Session);
+static uint8_t Session_Check(const uint8_t *Header);
+static void Session_Evict(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Current is the ID of the store's open session; archived IDs count
+// back from it, which orders the table across the 8-bit wrap
+void Session_Load(const uint8_t Current)
+{
+    uint8_t age[SESSION_SLOTS];
+    uint8_t magic;
+    Session_t session;
+
+    SESSION_BACKEND.Init();
+    PageCache_Init(&SESSION_BACKEND);
+    Session_Total = 0;
+    Session_Records = 0;
+
+    PageCache_Read(&magic, SESSION_START_ADDR, 1);
+    if (magic != SESSION_MAGIC) {
+        // Never used, or left over from a larger roster: empty table
+        uint8_t mark = SESSION_MARK_EMPTY;
+
+        for (uint8_t slot = 0; slot < SESSION_SLOTS; slot++) {
+            PageCache_Write(&mark, SESSION_HEADER(slot) + SESSION_HEADER_MARK, 1);
+        }
+        magic = SESSION_MAGIC;
+        PageCache_Write(&magic, SESSION_START_ADDR, 1);
+        return;
+    }
+
+    for (uint8_t slot = 0; slot < SESSION_SLOTS; slot++) {
+        uint8_t i;
+
+        if (!Session_ReadHeader(slot, &session)) continue;
+        // Insertion by age, newest first
+        for (i = Session_Total; i && age[i - 1] > (uint8_t)(Current - session.Id); i--) {
+            age[i] = age[i - 1];
+            Session_Order[i] = Session_Order[i - 1];
+        }
+        age[i] = Current - session.Id;
+        Session_Order[i] = slot;
+        Session_Total++;
+        Session_Records += session.Count;
+    }
+}
+
+uint8_t Session_Count(void)
+{
+    return Session_Total;
+}
+
+// Index 0 is the newest archived session. The result is overwritten
+// by the next Get or Find.
+const Session_t *Session_Get(const uint8_t Index)
+{
+    if (Index >= Session_Total) return NULL;
+    Session_ReadHeader(Session_Order[Index], &Session_Found);
+    return &Session_Found;
+}
+
+const Session_t *Session_Find(const uint8_t Id)
+{
+    for (uint8_t i = 0; i < Session_Total; i++) {
+        uint8_t id;
+
+        PageCache_Read(&id, SESSION_HEADER(Session_Order[i]) + SESSION_HEADER_ID, 1);
+        if (id == Id) return Session_Get(i);
+    }
+    return NULL;
+}
+
+// Record Index of Session, straight from its place in the record area
+void Session_ReadRecord(const Session_t *Session, const uint8_t Index, uint32_t *Packed, uint32_t *Timestamp)
+{
+    uint8_t record[SESSION_RECORD_SIZE];
+
+    PageCache_Read(record, SESSION_RECORD((Session->First + Index) % SESSION_CAPACITY), sizeof(record));
+    *Packed = record[0] | ((uint32_t)record[1] << 8) | ((uint32_t)record[2] << 16);
+    *Timestamp = Session->Start + (record[PACKED_ID_SIZE] | ((uint16_t)record[PACKED_ID_SIZE + 1] << 8)) * (uint32_t)STORE_TIME_STEP;
+}
+
+// 1 if the records of Session still match the CRC in its header
+uint8_t Session_Verify(const Session_t *Session)
+{
+    uint8_t record[SESSION_RECORD_SIZE];
+    uint16_t crc = FRAME_CRC_INIT;
+
+    for (uint8_t i = 0; i < Session->Count; i++) {
+        PageCache_Read(record, SESSION_RECORD((Session->First + i) % SESSION_CAPACITY), sizeof(record));
+        crc = Frame_Crc16(crc, record, sizeof(record));
+    }
+    return crc == Session->Crc;
+}
+
+// Drops the oldest sessions until Count records and a header fit,
+// then places the new session after the newest one
+void Session_Begin(const uint8_t Id, const uint32_t Start, const uint8_t Count)
+{
+    while (Session_Total == SESSION_SLOTS || SESSION_CAPACITY - Session_Records < Count) {
+        Session_Evict();
+    }
+
+    // First header slot no kept session uses
+    for (Session_Open.Slot = 0; ; Session_Open.Slot++) {
+        uint8_t i;
+
+        for (i = 0; i < Session_Total && Session_Order[i] != Session_Open.Slot; i++);
+        if (i == Session_Total) break;
+    }
+
+    Session_Open.Id = Id;
+    Session_Open.Start = Start;
+    Session_Open.Count = Count;
+    Session_Open.Crc = FRAME_CRC_INIT;
+    Session_Open.First = 0;
+    if (Session_Total) {
+        const Session_t *newest = Session_Get(0);
+        Session_Open.First = (newest->First + newest->Count) % SESSION_CAPACITY;
+    }
+}
+
+// Records of one session are contiguous, so they go out as page writes.
+// Index runs from 0 up, the record CRC is built on the way.
+void Session_Append(const uint8_t Index, const uint32_t Packed, const uint16_t Minute)
+{
+    uint8_t record[SESSION_RECORD_SIZE] = {
+        Packed & 0xFF, (Packed >> 8) & 0xFF, (Packed >> 16) & 0xFF,
+        Minute & 0xFF, Minute >> 8
+    };
+
+    PageCache_Write(record, SESSION_RECORD((Session_Open.First + Index) % SESSION_CAPACITY), sizeof(record));
+    Session_Open.Crc = Frame_Crc16(Session_Open.Crc, record, sizeof(record));
+}
+
+// Header after the records, mark last. Returns once it is stored, so
+// the store may clear the list behind it even on another chip.
+void Session_Commit(void)
+{
+    uint16_t addr = SESSION_HEADER(Session_Open.Slot);
+    uint8_t header[SESSION_HEADER_MARK];
+    uint8_t mark = SESSION_MARK_EMPTY;
+
+    header[SESSION_HEADER_ID] = Session_Open.Id;
+    memcpy(&header[SESSION_HEADER_START], &Session_Open.Start, sizeof(Session_Open.Start));    // Little endian, as AVR
+    memcpy(&header[SESSION_HEADER_FIRST], &Session_Open.First, sizeof(Session_Open.First));
+    header[SESSION_HEADER_COUNT] = Session_Open.Count;
+    memcpy(&header[SESSION_HEADER_CRC], &Session_Open.Crc, sizeof(Session_Open.Crc));
+    header[SESSION_HEADER_CHECK] = Session_Check(header);
+
+    PageCache_Write(&mark, addr + SESSION_HEADER_MARK, 1);
+    PageCache_Write(header, addr, sizeof(header));
+    mark = SESSION_MARK_VALID;
+    PageCache_Write(&mark, addr + SESSION_HEADER_MARK, 1);
+
+    memmove(&Session_Order[1], &Session_Order[0], Session_Total);
+    Session_Order[0] = Session_Open.Slot;
+    Session_Total++;
+    Session_Records += Session_Open.Count;
+    PageCache_Flush();
+}
+
+// 1 if Slot holds a committed, sane header
+static uint8_t Session_ReadHeader(const uint8_t Slot, Session_t *Session)
+{
+    uint8_t header[SESSION_HEADER_SIZE];
+
+    PageCache_Read(header, SESSION_HEADER(Slot), sizeof(header));
+    Session->Id = header[SESSION_HEADER_ID];
+    Session->Slot = Slot;
+    memcpy(&Session->First, &header[SESSION_HEADER_FIRST], sizeof(Session->First));
+    Session->Count = header[SESSION_HEADER_COUNT];
+    memcpy(&Session->Crc, &header[SESSION_HEADER_CRC], sizeof(Session->Crc));
+    memcpy(&Session->Start, &header[SESSION_HEADER_START], sizeof(Session->Start));
+
+    return header[SESSION_HEADER_MARK] == SESSION_MARK_VALID
+            && header[SESSION_HEADER_CHECK] == Session_Check(header)
+            && Session->First < SESSION_CAPACITY
+            && Session->Count && Session->Count <= MAX_STUDENTS;
+}
+
+// CRC-8 (polynomial 0x07) over the header fields
+static uint8_t Session_Check(const uint8_t *Header)
+{
+    uint8_t crc = 0xFF;
+
+    for (uint8_t i = 0; i < SESSION_HEADER_CHECK; i++) {
+        crc = _crc8_ccitt_update(crc, Header[i]);
+    }
+    return crc;
+}
+
+// Oldest session out; its header goes before its records are reused
+static void Session_Evict(void)
+{
+    Session_t oldest;
+    uint8_t mark = SESSION_MARK_EMPTY;
+
+    Session_Total--;
+    Session_ReadHeader(Session_Order[Session_Total], &oldest);
+    Session_Records -= oldest.Count;
+    PageCache_Write(&mark, SESSION_HEADER(oldest.Slot) + SESSION_HEADER_MARK, 1);
+}
+//---------------------------//
@@ -0,0 +1,57 @@
+#include "EEQueue.h"
+#include "I2CMem.h"
+#include "Storage.h"
+
+//----- Prototypes ----------------------------//
+static void Storage_InternalInit(void);
+static void Storage_InternalRead(void *Dst, const uint16_t Addr, uint16_t Length);
+static void Storage_InternalWrite(const void *Src, const uint16_t Addr, uint16_t Length);
+static void Storage_I2CRead(void *Dst, const uint16_t Addr, uint16_t Length);
+static void Storage_I2CWrite(const void *Src, const uint16_t Addr, uint16_t Length);
+//---------------------------------------------//
+
+//----- Backends ------------//
+const Storage_t Storage_Internal = {
+    Storage_InternalInit, Storage_InternalRead, Storage_InternalWrite, EEQueue_IsIdle
+};
+const Storage_t Storage_I2C = {
+    I2CMem_Init, Storage_I2CRead, Storage_I2CWrite, I2CMem_IsIdle
+};
+//---------------------------//
+
+//----- Functions -------------//
+// The EEPROM needs no setup, EEQueue starts empty
+static void Storage_InternalInit(void)
+{
+}
+
+static void Storage_InternalRead(void *Dst, const uint16_t Addr, uint16_t Length)
+{
+    uint8_t *dst = Dst;
+
+    for (uint16_t addr = Addr; Length; Length--) {
+        *dst++ = EEQueue_ReadByte(addr++);
+    }
+}
+
+static void Storage_InternalWrite(const void *Src, const uint16_t Addr, uint16_t Length)
+{
+    const uint8_t *src = Src;
+
+    for (uint16_t addr = Addr; Length; Length--) {
+        EEQueue_WriteByte(addr++, *src++);
+    }
+}
+
+// A missing chip reads as erased and drops writes; callers treat
+// it like a blank one
+static void Storage_I2CRead(void *Dst, const uint16_t Addr, uint16_t Length)
+{
+    I2CMem_Read(Dst, Addr, Length);
+}
+
+static void Storage_I2CWrite(const void *Src, const uint16_t Addr, uint16_t Length)
+{
+    I2CMem_Write(Src, Addr, Length);
+}
+//---------------------------//
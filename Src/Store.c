@@ -0,0 +1,1018 @@
+#include <string.h>
+#include <util/crc16.h>
+
+#include "EEQueue.h"
+#include "Roster.h"
+#include "Session.h"
+#include "Store.h"
+
+//----- Auxiliary data ------//
+static uint8_t studentCount = 0;             // Present students
+static uint8_t recordSlots = 0;              // Used entries, tombstones included
+// Present list as parallel arrays: scans and probes only touch the IDs
+static __uint24 presentIds[MAX_STUDENTS];    // Packed, STORE_RECORD_DEAD once removed
+static uint16_t presentMinutes[MAX_STUDENTS]; // After the session epoch
+static uint16_t presentSeqs[MAX_STUDENTS];   // Sequence number of its newest slot
+static uint16_t presentAdds[MAX_STUDENTS];   // Of the add itself, copies keep it
+static uint8_t recordIndex[STORE_INDEX_SIZE];    // Record index + 1, 0 = empty
+
+static uint8_t ringHead = STORE_RING_SLOTS - 1;  // Newest slot
+static uint8_t ringUsed = 0;                 // Slots written, STORE_RING_SLOTS once wrapped
+static uint16_t storeSeq = 0;                // Sequence number of the head slot
+static uint16_t syncCursor = 0;              // Last sequence the host acknowledged
+static uint16_t metaSeq = 0;                 // Newest metadata slot
+static uint8_t metaValid = 0;
+static uint8_t ringPending = 0;              // Window not checked since the last write
+static uint32_t storeEpoch = 0;              // Session start, seconds
+static uint16_t epochSeq = 0;                // Newest epoch slot
+static uint8_t epochValid = 0;
+static uint8_t storeSession = 0;             // ID of the newest session
+static uint16_t clearSeq = 0;                // Newest clear slot
+static uint16_t clearOrigin = 0;             // Sequence the session was closed at
+static uint8_t clearValid = 0;
+
+#define SLOT_ADDR(Slot)         (STORE_RING_ADDR + (uint16_t)(Slot) * STORE_ENTRY_SIZE)
+#define RING_SLOT(Slot, Ahead)  (((uint16_t)(Slot) + (Ahead)) % STORE_RING_SLOTS)
+#define RING_OLDEST()           RING_SLOT(ringHead, STORE_RING_SLOTS + 1 - ringUsed)
+// Slot of a sequence number still in the ring
+#define SEQ_SLOT(Seq)           RING_SLOT(ringHead, STORE_RING_SLOTS - (uint16_t)(storeSeq - (Seq)))
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void findHead(void);
+static uint8_t slotSeq(const uint8_t Slot, uint16_t *Seq);
+static uint16_t ringWrite(const uint8_t Kind, const uint8_t *Payload);
+static uint16_t slotWrite(const uint8_t Kind, const uint8_t *Payload);
+static uint16_t ringWriteRecord(const uint8_t Kind, const uint32_t Packed, const uint16_t Minute);
+static void startSession(const uint32_t Timestamp);
+static void writeEpoch(void);
+static void clearSession(void);
+static void writeClear(void);
+static void ringMaintain(void);
+static uint8_t ringMaintainStep(void);
+static uint8_t readEntry(const uint8_t Slot, uint8_t *Entry);
+static uint8_t entryCheck(const uint8_t *Entry, const uint8_t Kind);
+static void replayEntry(const uint8_t *Entry);
+static uint8_t isLive(const uint8_t *Entry);
+static uint8_t isNeeded(const uint8_t *Entry);
+static int16_t findPacked(const uint32_t Packed);
+static uint8_t indexHome(const uint32_t Packed);
+static uint8_t indexProbe(const uint32_t Packed);
+static void indexRemove(const uint8_t Pos);
+static void indexRebuild(void);
+static uint8_t recordSeek(const uint16_t Minute, const uint32_t Packed);
+static void insertRecord(const uint32_t Packed, const uint16_t Minute, const uint16_t Seq);
+static void deleteRecord(const uint8_t Index);
+static void compactRecords(void);
+static void clearRecords(void);
+static void loadLegacy(const uint8_t Count);
+static uint16_t encodeMinute(const uint32_t Timestamp);
+static uint32_t decodeMinute(const uint16_t Minute);
+static uint16_t entrySeq(const uint8_t *Entry);
+static uint32_t entryPacked(const uint8_t *Entry);
+static uint16_t entryMinute(const uint8_t *Entry);
+static void encodeSync(uint8_t *Out, const uint8_t Kind, const uint16_t Seq, const uint32_t Packed, const uint32_t Timestamp);
+static uint8_t syncDelta(StoreSync_t *Sync, uint8_t *Out);
+//---------------------------------------------//
+
+//----- Functions -------------//
+void Store_Load(void)
+{
+    uint8_t magic = EEQueue_ReadByte(EEPROM_START_ADDR);
+    uint8_t entry[STORE_ENTRY_SIZE];
+    uint16_t seq;
+
+    // First clear all records
+    clearRecords();
+    storeSeq = syncCursor = 0;
+    metaValid = epochValid = clearValid = 0;
+    storeSession = 0;
+    storeEpoch = 0;
+    ringHead = STORE_RING_SLOTS - 1;
+    ringUsed = 0;
+
+    if (magic != STORE_MAGIC) {
+        // v1 layout (magic is its record count) or blank EEPROM: format
+        if (magic <= STORE_V1_MAX) loadLegacy(magic);
+        compactRecords();
+        // The old image is in RAM now and the ring overwrites it. A torn
+        // conversion finds neither magic and starts empty rather than
+        // replaying half an image.
+        EEQueue_WriteByte(EEPROM_START_ADDR, 0xFF);
+        for (uint8_t slot = 0; slot < STORE_RING_SLOTS; slot++) {
+            EEQueue_WriteByte(SLOT_ADDR(slot) + STORE_ENTRY_KIND, STORE_KIND_END);
+        }
+        ringHead = STORE_RING_SLOTS - 1;
+        ringUsed = 0;
+
+        // Sequence numbers carry on. The old changes are gone, so the
+        // clear slot sends the host a snapshot.
+        if (metaValid) metaSeq = ringWriteRecord(STORE_KIND_META, syncCursor, 0);
+        writeClear();
+        if (epochValid) writeEpoch();
+        for (uint8_t i = 0; i < recordSlots; i++) {
+            presentSeqs[i] = presentAdds[i] = ringWriteRecord(STORE_KIND_ADD, presentIds[i], presentMinutes[i]);
+        }
+        // Magic last: a torn conversion starts over
+        EEQueue_WriteByte(EEPROM_START_ADDR, STORE_MAGIC);
+    } else {
+        // Only slots that continue the sequence up to the head count
+        findHead();
+        seq = storeSeq - ringUsed;
+        for (uint8_t n = 0, slot = RING_OLDEST(); n < ringUsed; n++, slot = RING_SLOT(slot, 1)) {
+            seq++;
+            if (readEntry(slot, entry) != STORE_KIND_END && entrySeq(entry) == seq) replayEntry(entry);
+        }
+        compactRecords();
+        // Adds the host has seen, kept or not copied yet: any sequence up
+        // to the cursor will do. Others keep the oldest one the ring had.
+        for (uint8_t i = 0; i < recordSlots; i++) {
+            if (readEntry(SEQ_SLOT(presentSeqs[i]), entry) == STORE_KIND_KEEP
+                    || !STORE_SEQ_AFTER(presentAdds[i], syncCursor)) {
+                presentAdds[i] = syncCursor;
+            }
+        }
+        // Copies may be owed from before the reset
+        ringPending = 1;
+        ringMaintain();
+    }
+
+    // Archived, but reset before the clear slot. The list may come back
+    // empty if its adds were still queued; the session is closed anyway.
+    Session_Load(storeSession);
+    if (epochValid && Session_Count() && Session_Get(0)->Id == storeSession) clearSession();
+}
+
+uint8_t Store_Count(void)
+{
+    return studentCount;
+}
+
+// Upper bound for record indexes
+uint8_t Store_Slots(void)
+{
+    return recordSlots;
+}
+
+// 0 for a removed record not compacted yet
+uint8_t Store_IsLive(const uint8_t Index)
+{
+    return !(presentIds[Index] & STORE_RECORD_DEAD);
+}
+
+// Index of Id in the list, -1 if absent. One hash probe sequence,
+// not a scan of the list.
+int16_t Store_Find(const char *Id)
+{
+    // Only valid IDs pack without aliasing
+    if (!validateStudentID(Id)) return -1;
+    return findPacked(packStudentID(Id));
+}
+
+StoreStatus_t Store_Add(const char *Id, const uint32_t Timestamp)
+{
+    uint32_t packed;
+    int16_t enrolled;
+    uint16_t minute;
+    uint16_t seq;
+
+    if (!validateStudentID(Id)) return STORE_INVALID;
+    packed = packStudentID(Id);
+    // Enrolled students are one bit in the roster, others go by the index
+    enrolled = Roster_Find(packed);
+    if (enrolled >= 0 ? Roster_IsPresent(enrolled) : findPacked(packed) >= 0) return STORE_DUPLICATE;
+    if (studentCount >= MAX_STUDENTS) return STORE_FULL;
+
+    // Nobody present: a time the session cannot express starts a new one
+    if (studentCount == 0 && (!epochValid || Timestamp < storeEpoch
+            || (Timestamp - storeEpoch) / STORE_TIME_STEP > 0xFFFF)) {
+        startSession(Timestamp);
+    }
+
+    // One slot, whatever the list length
+    minute = encodeMinute(Timestamp);
+    seq = ringWriteRecord(STORE_KIND_ADD, packed, minute);
+    insertRecord(packed, minute, seq);
+    if (enrolled >= 0) Roster_SetPresent(enrolled, 1);
+    return STORE_OK;
+}
+
+// A RAM tombstone and one ring slot, wherever the record sits
+StoreStatus_t Store_Remove(const char *Id)
+{
+    int16_t index = Store_Find(Id);
+    int16_t enrolled;
+
+    if (index < 0) return STORE_NOT_FOUND;
+
+    deleteRecord(index);
+    ringWriteRecord(STORE_KIND_REMOVE, packStudentID(Id), 0);
+    enrolled = Roster_Find(packStudentID(Id));
+    if (enrolled >= 0) Roster_SetPresent(enrolled, 0);
+    return STORE_OK;
+}
+
+// Idle work: the copying that keeps the ring window free, one slot
+// per call while the EEPROM is idle, then squeezing out tombstones.
+// Compact moves records, so pass 0 while record indexes are held.
+void Store_Service(const uint8_t Compact)
+{
+    if (ringPending && EEQueue_IsIdle()) ringMaintainStep();
+    if (Compact && recordSlots != studentCount) compactRecords();
+}
+
+// Writes the 8-digit ID of record Index and a terminator to Id. Text
+// is only made here, for display and export.
+void Store_RecordID(const uint8_t Index, char *Id)
+{
+    unpackStudentID(presentIds[Index], Id);
+}
+
+uint32_t Store_RecordPacked(const uint8_t Index)
+{
+    return presentIds[Index];
+}
+
+// Seconds on the Clock_Seconds() scale, to the minute
+uint32_t Store_RecordTime(const uint8_t Index)
+{
+    return decodeMinute(presentMinutes[Index]);
+}
+
+// Archives the present list as the current session, then empties it.
+// The archive may drop its oldest sessions to make room.
+StoreStatus_t Store_CloseSession(void)
+{
+    uint8_t n = 0;
+
+    if (!studentCount) return STORE_NOT_FOUND;
+
+    Session_Begin(storeSession, storeEpoch, studentCount);
+    for (uint8_t i = 0; i < recordSlots; i++) {
+        if (Store_IsLive(i)) Session_Append(n++, presentIds[i], presentMinutes[i]);
+    }
+    Session_Commit();
+    clearSession();
+    // Reported closed only once the clear slot is in the EEPROM
+    EEQueue_Flush();
+    return STORE_OK;
+}
+
+// ID of the open session, or of the last one closed
+uint8_t Store_Session(void)
+{
+    return storeSession;
+}
+
+// Records checked in at From or later and before To (seconds, To
+// exclusive; STORE_TIME_END for no end). The range keeps the key of
+// the next record rather than its index, so the list may change
+// between steps.
+void Store_RangeBegin(StoreRange_t *Range, const uint32_t From, const uint32_t To)
+{
+    uint32_t minute = 0;
+
+    // First time step at or after From
+    if (From > storeEpoch) minute = (From - storeEpoch + STORE_TIME_STEP - 1) / STORE_TIME_STEP;
+    Range->Minute = minute;
+    Range->Packed = 0;
+    Range->To = To;
+    Range->Done = minute > 0xFFFF || From >= To;
+}
+
+// Index of the next live record in the range, -1 past its end. One
+// binary search, then a few tombstones at most.
+int16_t Store_RangeNext(StoreRange_t *Range)
+{
+    uint8_t i;
+
+    if (Range->Done) return -1;
+    for (i = recordSeek(Range->Minute, Range->Packed); i < recordSlots && !Store_IsLive(i); i++);
+    if (i == recordSlots || decodeMinute(presentMinutes[i]) >= Range->To) {
+        Range->Done = 1;
+        return -1;
+    }
+    Range->Minute = presentMinutes[i];
+    Range->Packed = presentIds[i] + 1;
+    return i;
+}
+
+// Records the range has left to deliver
+uint8_t Store_RangeCount(const StoreRange_t *Range)
+{
+    uint8_t count = 0;
+
+    if (Range->Done) return 0;
+    for (uint8_t i = recordSeek(Range->Minute, Range->Packed);
+            i < recordSlots && decodeMinute(presentMinutes[i]) < Range->To; i++) {
+        if (Store_IsLive(i)) count++;
+    }
+    return count;
+}
+
+// Schema 1 export records (packed ID, timestamp) from a range of the
+// present list, in time order, so streaming needs no copy of it
+uint16_t Store_StreamBegin(StoreStream_t *Stream, const uint32_t Since)
+{
+    Stream->Length[0] = Stream->Length[1] = 0;
+    Stream->Out = 0;
+    Stream->Short = 0;
+    Stream->Archived = 0;
+    Store_RangeBegin(&Stream->Range, Since, STORE_TIME_END);
+    // Binary search to the first record, then a count for the frame header
+    Stream->Left = Store_RangeCount(&Stream->Range);
+    return Stream->Left;
+}
+
+// The same from an archived session, read from its backend a few
+// records at a time through the page cache. 0 if there is no such
+// session.
+uint16_t Store_StreamSession(StoreStream_t *Stream, const uint8_t Id)
+{
+    const Session_t *session = Session_Find(Id);
+
+    Stream->Length[0] = Stream->Length[1] = 0;
+    Stream->Out = 0;
+    Stream->Short = 0;
+    Stream->Archived = 1;
+    Stream->Session = Id;
+    Stream->Next = 0;
+    Stream->Left = session ? session->Count : 0;
+    return Stream->Left;
+}
+
+// Refills every free half from the source; returns the bytes ready in Data[Out]
+uint8_t Store_StreamFill(StoreStream_t *Stream)
+{
+    // Out first, so records keep their order across the halves
+    for (uint8_t half = Stream->Out, n = 0; n < 2; half ^= 1, n++) {
+        const Session_t *session = NULL;
+
+        if (Stream->Length[half]) continue;
+        // Looked up again per half: a close meanwhile may evict it
+        if (Stream->Archived && !Stream->Short) session = Session_Find(Stream->Session);
+        // Never deliver more than the header announced, nor less
+        while (Stream->Left && Stream->Length[half] < sizeof(Stream->Data[half])) {
+            uint8_t *out = &Stream->Data[half][Stream->Length[half]];
+            uint32_t packed = 0, timestamp = 0;
+            int16_t index;
+
+            if (Stream->Short) {
+                // Padding keeps the frame length the header announced
+            } else if (Stream->Archived) {
+                if (session) Session_ReadRecord(session, Stream->Next++, &packed, &timestamp);
+                else Stream->Short = 1;
+            } else if ((index = Store_RangeNext(&Stream->Range)) >= 0) {
+                packed = presentIds[index];
+                timestamp = decodeMinute(presentMinutes[index]);
+            } else {
+                // Removed since the count was taken
+                Stream->Short = 1;
+            }
+
+            memcpy(out, &packed, PACKED_ID_SIZE);                               // Little endian, as AVR
+            memcpy(out + PACKED_ID_SIZE, &timestamp, sizeof(timestamp));
+            Stream->Length[half] += EXPORT_RECORD_SIZE;
+            Stream->Left--;
+        }
+    }
+    return Stream->Length[Stream->Out];
+}
+
+// Data[Out] is queued: hand it back for filling and drain the other half
+void Store_StreamRelease(StoreStream_t *Stream)
+{
+    Stream->Length[Stream->Out] = 0;
+    Stream->Out ^= 1;
+}
+
+// Fixes the change range (cursor, now] and counts the records to send
+void Store_SyncBegin(StoreSync_t *Sync, const uint8_t Full)
+{
+    uint8_t entry[STORE_ENTRY_SIZE];
+
+    Sync->Since = syncCursor;
+    Sync->Upto = storeSeq;
+    Sync->Next = syncCursor + 1;
+    Sync->Short = 0;
+    Store_RangeBegin(&Sync->Range, 0, STORE_TIME_END);
+    // The slot after the cursor was overwritten, or the list was
+    // cleared since: deltas would miss changes
+    Sync->Full = Full || (uint16_t)(storeSeq - syncCursor) > ringUsed
+            || (clearValid && STORE_SEQ_AFTER(clearOrigin, syncCursor));
+    Sync->Count = 1;
+
+    if (Sync->Full) {
+        Sync->Count += studentCount;
+    } else {
+        // Adds by their own sequence from the list, removals from the ring
+        for (uint8_t i = 0; i < recordSlots; i++) {
+            if (Store_IsLive(i) && STORE_SEQ_AFTER(presentAdds[i], Sync->Since)) Sync->Count++;
+        }
+        for (uint8_t n = 0, slot = RING_OLDEST(); n < ringUsed; n++, slot = RING_SLOT(slot, 1)) {
+            if (readEntry(slot, entry) == STORE_KIND_REMOVE
+                    && STORE_SEQ_AFTER(entrySeq(entry), Sync->Since)) Sync->Count++;
+        }
+    }
+    Sync->Left = Sync->Count;
+}
+
+// Next change after Since, by sequence number; 0 past Upto
+static uint8_t syncDelta(StoreSync_t *Sync, uint8_t *Out)
+{
+    uint8_t entry[STORE_ENTRY_SIZE];
+
+    for (; !STORE_SEQ_AFTER(Sync->Next, Sync->Upto); Sync->Next++) {
+        const uint16_t seq = Sync->Next;
+
+        // A copy keeps the add's own sequence, so the list has it
+        // even once the slot has moved
+        for (uint8_t i = 0; i < recordSlots; i++) {
+            if (Store_IsLive(i) && presentAdds[i] == seq) {
+                encodeSync(Out, SYNC_KIND_ADDED, seq, presentIds[i], Store_RecordTime(i));
+                Sync->Next++;
+                return 1;
+            }
+        }
+        // Removals stay in place until the ring turns over
+        if ((uint16_t)(storeSeq - seq) < ringUsed && readEntry(SEQ_SLOT(seq), entry) == STORE_KIND_REMOVE
+                && entrySeq(entry) == seq) {
+            encodeSync(Out, SYNC_KIND_REMOVED, seq, entryPacked(entry), 0);
+            Sync->Next++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Fills Out with the next sync record, 0 once Count have been given.
+// Snapshots walk the list by key, deltas by sequence number, so
+// changes made meanwhile shift nothing; those after Upto are left for
+// the next sync. A change lost since Begin (removed, or its slot
+// overwritten) leaves zero records at the end: the host rejects the
+// frame and, having acknowledged nothing, simply asks again.
+uint8_t Store_SyncNext(StoreSync_t *Sync, uint8_t *Out)
+{
+    int16_t index;
+
+    if (!Sync->Left) return 0;
+    if (Sync->Left == Sync->Count) {
+        encodeSync(Out, Sync->Full ? SYNC_KIND_SNAPSHOT : SYNC_KIND_DELTA, Sync->Upto, 0, Sync->Since);
+    } else if (Sync->Short) {
+        memset(Out, 0, SYNC_RECORD_SIZE);
+    } else if (!Sync->Full) {
+        if (!syncDelta(Sync, Out)) {
+            memset(Out, 0, SYNC_RECORD_SIZE);
+            Sync->Short = 1;
+        }
+    } else {
+        // By the add's own sequence: a copy made since Begin does not
+        // push a record out of the snapshot
+        while ((index = Store_RangeNext(&Sync->Range)) >= 0 && STORE_SEQ_AFTER(presentAdds[index], Sync->Upto));
+        if (index >= 0) {
+            encodeSync(Out, SYNC_KIND_ADDED, presentAdds[index], presentIds[index], Store_RecordTime(index));
+        } else {
+            memset(Out, 0, SYNC_RECORD_SIZE);
+            Sync->Short = 1;
+        }
+    }
+    Sync->Left--;
+    return 1;
+}
+
+uint16_t Store_SyncCursor(void)
+{
+    return syncCursor;
+}
+
+// Host confirms it holds everything up to Seq
+StoreStatus_t Store_SyncAck(const uint16_t Seq)
+{
+    if (Seq == syncCursor) return STORE_OK;
+    if (!STORE_SEQ_AFTER(Seq, syncCursor) || STORE_SEQ_AFTER(Seq, storeSeq)) return STORE_BAD_SEQ;
+
+    // A fresh metadata slot each time, the cursor has no fixed address
+    syncCursor = Seq;
+    metaSeq = ringWriteRecord(STORE_KIND_META, Seq, 0);
+    metaValid = 1;
+    return STORE_OK;
+}
+
+uint8_t validateStudentID(const char *id)
+{
+    // Validate year (20-23)
+    if (id[0] != '2') return 0;
+    if (id[1] < '0' || id[1] > '3') return 0;
+
+    // Validate department (001-999)
+    if (id[2] < '0' || id[2] > '9') return 0;
+    if (id[3] < '0' || id[3] > '9') return 0;
+    if (id[4] < '0' || id[4] > '9') return 0;
+    if (id[2] == '0' && id[3] == '0' && id[4] == '0') return 0;
+
+    // Validate student number (001-999)
+    if (id[5] < '0' || id[5] > '9') return 0;
+    if (id[6] < '0' || id[6] > '9') return 0;
+    if (id[7] < '0' || id[7] > '9') return 0;
+    if (id[5] == '0' && id[6] == '0' && id[7] == '0') return 0;
+
+    return 1;
+}
+
+uint32_t packStudentID(const char *id)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < STUDENT_ID_LENGTH; i++) {
+        value = value * 10 + (id[i] - '0');
+    }
+    return value - STUDENT_ID_BASE;
+}
+
+void unpackStudentID(uint32_t packed, char *id)
+{
+    packed += STUDENT_ID_BASE;
+    for (int8_t i = STUDENT_ID_LENGTH - 1; i >= 0; i--) {
+        id[i] = '0' + (packed % 10);
+        packed /= 10;
+    }
+    id[STUDENT_ID_LENGTH] = '\0';
+}
+
+// Newest slot: the last i with seq[i] - seq[0] == i. A reset can tear
+// at most the slot being written; if that was slot 0, anchor on slot 1.
+static void findHead(void)
+{
+    uint16_t first, seq;
+    uint8_t anchor = 0;
+    uint8_t lo, hi;
+
+    if (!slotSeq(0, &first)) {
+        anchor = 1;
+        if (!slotSeq(1, &first)) return;    // Empty ring
+    }
+
+    lo = anchor;
+    hi = STORE_RING_SLOTS - 1;
+    while (lo < hi) {
+        uint8_t mid = lo + (hi - lo + 1) / 2;
+        if (slotSeq(mid, &seq) && (uint16_t)(seq - first) == mid - anchor) lo = mid;
+        else hi = mid - 1;
+    }
+    ringHead = lo;
+    slotSeq(ringHead, &storeSeq);
+
+    // Wrapped if a slot just ahead still continues the previous lap
+    ringUsed = ringHead + 1;
+    for (uint8_t ahead = 1; ahead <= 2; ahead++) {
+        if (slotSeq(RING_SLOT(ringHead, ahead), &seq)
+                && seq == (uint16_t)(storeSeq - STORE_RING_SLOTS + ahead)) {
+            ringUsed = STORE_RING_SLOTS;
+        }
+    }
+}
+
+// 1 if Slot holds a committed entry
+static uint8_t slotSeq(const uint8_t Slot, uint16_t *Seq)
+{
+    uint8_t entry[STORE_ENTRY_SIZE];
+    uint8_t kind = readEntry(Slot, entry);
+
+    *Seq = entrySeq(entry);
+    return kind >= STORE_KIND_ADD && kind <= STORE_KIND_CLEAR;
+}
+
+// Settles the copying still owed, then writes the slot after the head
+static uint16_t ringWrite(const uint8_t Kind, const uint8_t *Payload)
+{
+    ringMaintain();
+    return slotWrite(Kind, Payload);
+}
+
+// Queues the slot after the head and returns its sequence number.
+// The queue keeps the order below and skips unchanged bytes.
+static uint16_t slotWrite(const uint8_t Kind, const uint8_t *Payload)
+{
+    uint8_t slot = RING_SLOT(ringHead, 1);
+    uint16_t addr = SLOT_ADDR(slot);
+    uint16_t seq = storeSeq + 1;
+    uint8_t entry[STORE_ENTRY_KIND];
+
+    entry[STORE_ENTRY_SEQ] = seq & 0xFF;
+    entry[STORE_ENTRY_SEQ + 1] = seq >> 8;
+    memcpy(&entry[STORE_ENTRY_ID], Payload, STORE_PAYLOAD_SIZE);
+    entry[STORE_ENTRY_CHECK] = entryCheck(entry, Kind);
+
+    // Uncommit, fill, commit
+    EEQueue_WriteByte(addr + STORE_ENTRY_KIND, STORE_KIND_END);
+    EEQueue_WriteBlock(entry, addr, sizeof(entry));
+    EEQueue_WriteByte(addr + STORE_ENTRY_KIND, Kind);
+
+    ringHead = slot;
+    storeSeq = seq;
+    if (ringUsed < STORE_RING_SLOTS) ringUsed++;
+    ringPending = 1;
+    return seq;
+}
+
+static uint16_t ringWriteRecord(const uint8_t Kind, const uint32_t Packed, const uint16_t Minute)
+{
+    uint8_t payload[STORE_PAYLOAD_SIZE] = {
+        Packed & 0xFF, (Packed >> 8) & 0xFF, (Packed >> 16) & 0xFF,
+        Minute & 0xFF, Minute >> 8
+    };
+
+    return ringWrite(Kind, payload);
+}
+
+static void startSession(const uint32_t Timestamp)
+{
+    storeEpoch = Timestamp;
+    storeSession++;
+    writeEpoch();
+}
+
+// Epoch slot: the seconds in the first four payload bytes, then the
+// session ID
+static void writeEpoch(void)
+{
+    uint8_t payload[STORE_PAYLOAD_SIZE];
+
+    memcpy(payload, &storeEpoch, sizeof(storeEpoch));  // Little endian, as AVR
+    payload[sizeof(storeEpoch)] = storeSession;
+    epochSeq = ringWrite(STORE_KIND_EPOCH, payload);
+    epochValid = 1;
+}
+
+// Empties the list with one clear slot. Until the next session starts
+// the clear slot is kept instead of the epoch, as it holds the ID.
+static void clearSession(void)
+{
+    // Nothing left to copy forward
+    clearRecords();
+    Roster_Refresh();
+    epochValid = 0;
+    writeClear();
+}
+
+// Clear slot: session ID, then its own sequence number, which copies
+// keep. Syncs from before it get a snapshot.
+static void writeClear(void)
+{
+    uint8_t payload[STORE_PAYLOAD_SIZE] = { storeSession };
+
+    ringMaintain();
+    clearOrigin = storeSeq + 1;
+    payload[1] = clearOrigin & 0xFF;
+    payload[2] = clearOrigin >> 8;
+    clearSeq = slotWrite(STORE_KIND_CLEAR, payload);
+    clearValid = 1;
+}
+
+// Keeps STORE_RING_WINDOW free slots ahead of the head: a needed slot
+// about to enter the window is copied to the head first. The original
+// then counts as superseded, so the window grows back by one.
+static void ringMaintain(void)
+{
+    while (ringMaintainStep());
+}
+
+// 1 if a slot was copied. A slot only becomes needed when written at
+// the head, so once the window checks clear it stays clear until the
+// next write.
+static uint8_t ringMaintainStep(void)
+{
+    uint8_t entry[STORE_ENTRY_SIZE];
+    uint8_t kind;
+    uint16_t seq;
+
+    if (!ringPending) return 0;
+    kind = readEntry(RING_SLOT(ringHead, STORE_RING_WINDOW), entry);
+    if (!isNeeded(entry)) {
+        ringPending = 0;
+        return 0;
+    }
+
+    // An add the host has seen needs no resending
+    if (kind == STORE_KIND_ADD && !STORE_SEQ_AFTER(entrySeq(entry), syncCursor)) kind = STORE_KIND_KEEP;
+    seq = slotWrite(kind, &entry[STORE_ENTRY_ID]);
+
+    if (kind == STORE_KIND_META) metaSeq = seq;
+    else if (kind == STORE_KIND_EPOCH) epochSeq = seq;
+    else if (kind == STORE_KIND_CLEAR) clearSeq = seq;
+    else {
+        int16_t index = findPacked(entryPacked(entry));
+
+        // An unacknowledged add keeps its own sequence for syncs; one
+        // the host has seen is kept up with the cursor instead
+        presentSeqs[index] = seq;
+        if (kind == STORE_KIND_KEEP) presentAdds[index] = syncCursor;
+    }
+    return 1;
+}
+
+// Kind of the slot, STORE_KIND_END if it fails its check
+static uint8_t readEntry(const uint8_t Slot, uint8_t *Entry)
+{
+    EEQueue_ReadBlock(Entry, SLOT_ADDR(Slot), STORE_ENTRY_SIZE);
+    if (Entry[STORE_ENTRY_KIND] != STORE_KIND_END
+            && Entry[STORE_ENTRY_CHECK] != entryCheck(Entry, Entry[STORE_ENTRY_KIND])) {
+        Entry[STORE_ENTRY_KIND] = STORE_KIND_END;
+    }
+    return Entry[STORE_ENTRY_KIND];
+}
+
+// CRC-8 of a slot committed as Kind
+static uint8_t entryCheck(const uint8_t *Entry, const uint8_t Kind)
+{
+    uint8_t crc = STORE_CHECK_INIT;
+
+    for (uint8_t i = 0; i < STORE_ENTRY_CHECK; i++) {
+        crc = _crc8_ccitt_update(crc, Entry[i]);
+    }
+    return _crc8_ccitt_update(crc, Kind);
+}
+
+// Applies one slot, oldest first; later slots win
+static void replayEntry(const uint8_t *Entry)
+{
+    int16_t index;
+
+    switch (Entry[STORE_ENTRY_KIND]) {
+    case STORE_KIND_META:
+        syncCursor = entryPacked(Entry);
+        metaSeq = entrySeq(Entry);
+        metaValid = 1;
+        break;
+
+    case STORE_KIND_EPOCH:
+        memcpy(&storeEpoch, &Entry[STORE_ENTRY_ID], sizeof(storeEpoch));
+        storeSession = Entry[STORE_ENTRY_ID + sizeof(storeEpoch)];
+        epochSeq = entrySeq(Entry);
+        epochValid = 1;
+        break;
+
+    case STORE_KIND_CLEAR:
+        clearRecords();
+        storeSession = Entry[STORE_ENTRY_ID];
+        clearOrigin = Entry[STORE_ENTRY_ID + 1] | ((uint16_t)Entry[STORE_ENTRY_ID + 2] << 8);
+        clearSeq = entrySeq(Entry);
+        clearValid = 1;
+        epochValid = 0;
+        break;
+
+    case STORE_KIND_ADD:
+    case STORE_KIND_KEEP:
+        index = findPacked(entryPacked(Entry));
+        if (index >= 0 && presentMinutes[index] != entryMinute(Entry)) {
+            // Time order: a new time moves the record
+            deleteRecord(index);
+            index = -1;
+        }
+        if (index >= 0) {
+            // A copy: the add seen first stays the one syncs report
+            presentSeqs[index] = entrySeq(Entry);
+        } else if (studentCount < MAX_STUDENTS) {
+            insertRecord(entryPacked(Entry), entryMinute(Entry), entrySeq(Entry));
+        }
+        break;
+
+    case STORE_KIND_REMOVE:
+        index = findPacked(entryPacked(Entry));
+        if (index >= 0) deleteRecord(index);
+        break;
+    }
+}
+
+// An add (or copy) whose record is still present and not copied since
+static uint8_t isLive(const uint8_t *Entry)
+{
+    int16_t index;
+
+    if (Entry[STORE_ENTRY_KIND] != STORE_KIND_ADD && Entry[STORE_ENTRY_KIND] != STORE_KIND_KEEP) return 0;
+    index = findPacked(entryPacked(Entry));
+    return index >= 0 && presentSeqs[index] == entrySeq(Entry);
+}
+
+// Must survive the head passing over it
+static uint8_t isNeeded(const uint8_t *Entry)
+{
+    if (Entry[STORE_ENTRY_KIND] == STORE_KIND_META) return metaValid && entrySeq(Entry) == metaSeq;
+    if (Entry[STORE_ENTRY_KIND] == STORE_KIND_EPOCH) return epochValid && entrySeq(Entry) == epochSeq;
+    if (Entry[STORE_ENTRY_KIND] == STORE_KIND_CLEAR) return !epochValid && clearValid && entrySeq(Entry) == clearSeq;
+    return isLive(Entry);
+}
+
+static int16_t findPacked(const uint32_t Packed)
+{
+    uint8_t entry = recordIndex[indexProbe(Packed)];
+
+    return entry ? entry - 1 : -1;
+}
+
+// Fold to 16 bits, then Fibonacci hashing: the top bits of the product
+static uint8_t indexHome(const uint32_t Packed)
+{
+    uint16_t fold = (uint16_t)Packed ^ (uint16_t)(Packed >> 16);
+
+    return (uint16_t)(fold * 40503U) >> (16 - STORE_INDEX_BITS);
+}
+
+// Table position holding Packed, else the empty one where it would go.
+// The table is never full, so the probe ends.
+static uint8_t indexProbe(const uint32_t Packed)
+{
+    uint8_t pos = indexHome(Packed);
+
+    while (recordIndex[pos] && presentIds[recordIndex[pos] - 1] != Packed) {
+        pos = (pos + 1) & STORE_INDEX_MASK;
+    }
+    return pos;
+}
+
+// Backward shift deletion: later entries of the cluster that may sit
+// in the hole move into it, so lookups never need tombstones
+static void indexRemove(const uint8_t Pos)
+{
+    uint8_t hole = Pos;
+
+    for (uint8_t pos = (Pos + 1) & STORE_INDEX_MASK; recordIndex[pos]; pos = (pos + 1) & STORE_INDEX_MASK) {
+        uint8_t home = indexHome(presentIds[recordIndex[pos] - 1]);
+
+        if (((pos - home) & STORE_INDEX_MASK) >= ((pos - hole) & STORE_INDEX_MASK)) {
+            recordIndex[hole] = recordIndex[pos];
+            hole = pos;
+        }
+    }
+    recordIndex[hole] = 0;
+}
+
+// After compaction every record index changes
+static void indexRebuild(void)
+{
+    memset(recordIndex, 0, sizeof(recordIndex));
+    for (uint8_t i = 0; i < recordSlots; i++) {
+        recordIndex[indexProbe(presentIds[i])] = i + 1;
+    }
+}
+
+// First record at or after (Minute, Packed), tombstones included.
+// Binary search: the list is sorted on that key.
+static uint8_t recordSeek(const uint16_t Minute, const uint32_t Packed)
+{
+    uint8_t low = 0, high = recordSlots;
+
+    while (low < high) {
+        uint8_t mid = (low + high) / 2;
+
+        if (presentMinutes[mid] < Minute || (presentMinutes[mid] == Minute
+                && (presentIds[mid] & ~STORE_RECORD_DEAD) < Packed)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Check-ins arrive in time order and are appended. An earlier time
+// (replay, an old list, a clamped time) is moved into place.
+static void insertRecord(const uint32_t Packed, const uint16_t Minute, const uint16_t Seq)
+{
+    uint8_t pos;
+
+    // Tombstones wait for idle time, unless their room is needed now
+    if (recordSlots == MAX_STUDENTS) compactRecords();
+    pos = recordSlots;
+    if (pos && (presentMinutes[pos - 1] > Minute || (presentMinutes[pos - 1] == Minute
+            && (presentIds[pos - 1] & ~STORE_RECORD_DEAD) > Packed))) {
+        pos = recordSeek(Minute, Packed + 1);
+        memmove(&presentIds[pos + 1], &presentIds[pos], (recordSlots - pos) * sizeof(presentIds[0]));
+        memmove(&presentMinutes[pos + 1], &presentMinutes[pos], (recordSlots - pos) * sizeof(presentMinutes[0]));
+        memmove(&presentSeqs[pos + 1], &presentSeqs[pos], (recordSlots - pos) * sizeof(presentSeqs[0]));
+        memmove(&presentAdds[pos + 1], &presentAdds[pos], (recordSlots - pos) * sizeof(presentAdds[0]));
+        for (uint16_t i = 0; i < STORE_INDEX_SIZE; i++) {
+            if (recordIndex[i] > pos) recordIndex[i]++;
+        }
+    }
+    presentIds[pos] = Packed;
+    presentMinutes[pos] = Minute;
+    presentSeqs[pos] = presentAdds[pos] = Seq;
+    recordSlots++;
+    studentCount++;
+    recordIndex[indexProbe(Packed)] = pos + 1;
+}
+
+// O(1): the entry is marked, Store_Service() reclaims it later
+static void deleteRecord(const uint8_t Index)
+{
+    indexRemove(indexProbe(presentIds[Index]));
+    presentIds[Index] |= STORE_RECORD_DEAD;
+    studentCount--;
+    // Tombstones at the end cost nothing to drop
+    while (recordSlots && (presentIds[recordSlots - 1] & STORE_RECORD_DEAD)) {
+        recordSlots--;
+    }
+}
+
+// Squeezes out tombstones, keeping time order
+static void compactRecords(void)
+{
+    uint8_t used = 0;
+
+    for (uint8_t i = 0; i < recordSlots; i++) {
+        if (presentIds[i] & STORE_RECORD_DEAD) continue;
+        if (used != i) {
+            presentIds[used] = presentIds[i];
+            presentMinutes[used] = presentMinutes[i];
+            presentSeqs[used] = presentSeqs[i];
+            presentAdds[used] = presentAdds[i];
+        }
+        used++;
+    }
+    if (used == recordSlots) return;
+    recordSlots = used;
+    indexRebuild();
+}
+
+static void clearRecords(void)
+{
+    memset(presentIds, 0, sizeof(presentIds));
+    memset(recordIndex, 0, sizeof(recordIndex));
+    studentCount = recordSlots = 0;
+}
+
+// v1: count, then 8 ASCII digits + 4 byte timestamp per record.
+// The session starts at the earliest check-in.
+static void loadLegacy(const uint8_t Count)
+{
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        uint16_t addr = EEPROM_START_ADDR + 1;
+
+        for (uint8_t i = 0; i < Count; i++) {
+            char id[STUDENT_ID_LENGTH + 1];
+            uint32_t timestamp;
+
+            EEQueue_ReadBlock(id, addr, STUDENT_ID_LENGTH);
+            id[STUDENT_ID_LENGTH] = '\0';
+            EEQueue_ReadBlock(&timestamp, addr + STUDENT_ID_LENGTH, sizeof(timestamp));
+            addr += STUDENT_ID_LENGTH + sizeof(timestamp);
+
+            // Valid data check
+            if (!validateStudentID(id)) continue;
+            if (pass == 0) {
+                if (!epochValid || timestamp < storeEpoch) storeEpoch = timestamp;
+                epochValid = 1;
+            } else if (studentCount < MAX_STUDENTS) {
+                // MAX_STUDENTS may be set below STORE_V1_MAX; the rest is dropped
+                insertRecord(packStudentID(id), encodeMinute(timestamp), 0);
+            }
+        }
+    }
+}
+
+// Time steps (minutes by default) after the epoch, clamped to the session
+static uint16_t encodeMinute(const uint32_t Timestamp)
+{
+    uint32_t minutes;
+
+    if (Timestamp <= storeEpoch) return 0;
+    minutes = (Timestamp - storeEpoch) / STORE_TIME_STEP;
+    return minutes > 0xFFFF ? 0xFFFF : minutes;
+}
+
+static uint32_t decodeMinute(const uint16_t Minute)
+{
+    return storeEpoch + Minute * (uint32_t)STORE_TIME_STEP;
+}
+
+static uint16_t entrySeq(const uint8_t *Entry)
+{
+    return Entry[STORE_ENTRY_SEQ] | ((uint16_t)Entry[STORE_ENTRY_SEQ + 1] << 8);
+}
+
+static uint32_t entryPacked(const uint8_t *Entry)
+{
+    return Entry[STORE_ENTRY_ID] | ((uint32_t)Entry[STORE_ENTRY_ID + 1] << 8)
+            | ((uint32_t)Entry[STORE_ENTRY_ID + 2] << 16);
+}
+
+static uint16_t entryMinute(const uint8_t *Entry)
+{
+    return Entry[STORE_ENTRY_MINUTE] | ((uint16_t)Entry[STORE_ENTRY_MINUTE + 1] << 8);
+}
+
+static void encodeSync(uint8_t *Out, const uint8_t Kind, const uint16_t Seq, const uint32_t Packed, const uint32_t Timestamp)
+{
+    Out[0] = Kind;
+    Out[1] = Seq & 0xFF;
+    Out[2] = Seq >> 8;
+    Out[3] = Packed & 0xFF;
+    Out[4] = (Packed >> 8) & 0xFF;
+    Out[5] = (Packed >> 16) & 0xFF;
+    Out[6] = Timestamp & 0xFF;
+    Out[7] = (Timestamp >> 8) & 0xFF;
+    Out[8] = (Timestamp >> 16) & 0xFF;
+    Out[9] = (Timestamp >> 24) & 0xFF;
+}
+//---------------------------//
@@ -0,0 +1,217 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+#include "USART.h"
+
+//----- Auxiliary data ------//
+static volatile uint8_t USART_TxBuffer[USART_TX_BUFFER_SIZE];
+static volatile uint8_t USART_TxHead = 0;    // Next free slot, written by main
+static volatile uint8_t USART_TxTail = 0;    // Next byte out, written by the ISR
+static uint32_t USART_TxTotal = 0;           // Bytes queued since boot
+static volatile uint8_t USART_TxSent = 0;    // Anything queued since boot: TXC means something
+
+static volatile uint8_t USART_RxBuffer[USART_RX_BUFFER_SIZE];
+static volatile uint8_t USART_RxHead = 0;    // Written by the ISR
+static volatile uint8_t USART_RxTail = 0;    // Written by main
+static volatile uint8_t USART_RxLost = 0;    // Overruns, framing errors, full ring
+
+static volatile uint8_t USART_FlowEnabled = 0;
+static volatile uint8_t USART_FlowStopped = 0;  // XOFF sent (or pending)
+static volatile uint8_t USART_FlowPending = 0;  // XON/XOFF to send ahead of the ring
+
+// TXC is cleared by writing a one. A plain |= would write FE, DOR
+// and PE back as well; U2X is the only other bit to keep.
+#define USART_CLEAR_TXC()       (UCSRA = (UCSRA & (1 << U2X)) | (1 << TXC))
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void USART_Enqueue(const uint8_t Data);
+static void USART_Resume(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+void USART_Init(void)
+{
+    // Set baud rate, divisor and U2X picked at compile time (USART.h)
+    UBRRH = (unsigned char)(USART_UBRR >> 8);
+    UBRRL = (unsigned char)USART_UBRR;
+#if USART_USE_2X
+    UCSRA = (1 << U2X);
+#else
+    UCSRA = 0;
+#endif
+
+    // Enable transmitter and receiver, receive interrupt
+    UCSRB = (1 << RXEN) | (1 << TXEN) | (1 << RXCIE);
+
+    // Set frame format: 8 data bits, 1 stop bit
+    UCSRC = (1 << URSEL) | (1 << UCSZ1) | (1 << UCSZ0);
+}
+
+ISR(USART_RXC_vect)
+{
+    uint8_t status = UCSRA;
+    uint8_t data = UDR;                      // Always read to clear RXC
+    uint8_t head = USART_RxHead;
+    uint8_t next = (head + 1) & USART_RX_BUFFER_MASK;
+
+    if ((status & ((1 << FE) | (1 << DOR))) || next == USART_RxTail) {
+        if (USART_RxLost < 0xFF) USART_RxLost++;
+        if (next == USART_RxTail) return;
+    }
+    USART_RxBuffer[head] = data;
+    USART_RxHead = next;
+
+    // Throttle the host from here, the main loop may be busy for a while
+    if (USART_FlowEnabled && !USART_FlowStopped
+            && ((next - USART_RxTail) & USART_RX_BUFFER_MASK) >= USART_XOFF_LEVEL) {
+        USART_FlowStopped = 1;
+        USART_FlowPending = USART_XOFF;
+        UCSRB |= (1 << UDRIE);
+    }
+}
+
+ISR(USART_UDRE_vect)
+{
+    uint8_t tail = USART_TxTail;
+
+    // Flow control jumps the queue
+    if (USART_FlowPending) {
+        UDR = USART_FlowPending;
+        USART_FlowPending = 0;
+        return;
+    }
+    if (tail == USART_TxHead) {
+        // Drained: mute until the next enqueue
+        UCSRB &= ~(1 << UDRIE);
+        return;
+    }
+    UDR = USART_TxBuffer[tail];
+    USART_TxTail = (tail + 1) & USART_TX_BUFFER_MASK;
+}
+
+uint8_t USART_TxFree(void)
+{
+    // One slot stays empty to tell full from empty
+    return (USART_TxTail - USART_TxHead - 1) & USART_TX_BUFFER_MASK;
+}
+
+uint8_t USART_TryTransmit(const uint8_t Data)
+{
+    if (!USART_TxFree()) return 0;
+    USART_Enqueue(Data);
+    return 1;
+}
+
+uint8_t USART_TryWrite(const uint8_t *Data, const uint8_t Length)
+{
+    if (USART_TxFree() < Length) return 0;
+    for (uint8_t i = 0; i < Length; i++) USART_Enqueue(Data[i]);
+    return 1;
+}
+
+// Queues Str plus CR/LF as one unit, or nothing at all
+uint8_t USART_TryTransmitString(const char *Str)
+{
+    uint8_t length;
+
+    if (!Str) return 1;
+    length = strlen(Str);
+    if (USART_TxFree() < length + 2) return 0;
+
+    while (*Str) USART_Enqueue(*Str++);
+    USART_Enqueue('\r');
+    USART_Enqueue('\n');
+    return 1;
+}
+
+// Ring empty and the last stop bit has left the shift register. TXC
+// only sets after a transmission, so before the first one there is
+// nothing to wait for.
+uint8_t USART_TxDone(void)
+{
+    return USART_TxHead == USART_TxTail && !USART_FlowPending
+            && (!USART_TxSent || (UCSRA & (1 << TXC)));
+}
+
+uint32_t USART_TxCount(void)
+{
+    return USART_TxTotal;
+}
+
+void USART_Transmit(unsigned char Data)
+{
+    // Wait for room in the ring buffer
+    while (!USART_TxFree());
+    USART_Enqueue(Data);
+}
+
+void USART_TransmitString(const char *Str)
+{
+    if (!Str) return;
+
+    while (*Str) USART_Transmit(*Str++);
+    // Send newline
+    USART_Transmit('\r');
+    USART_Transmit('\n');
+}
+
+uint8_t USART_RxAvailable(void)
+{
+    return (USART_RxHead - USART_RxTail) & USART_RX_BUFFER_MASK;
+}
+
+int16_t USART_Read(void)
+{
+    uint8_t tail = USART_RxTail;
+    uint8_t data;
+
+    if (tail == USART_RxHead) return -1;
+    data = USART_RxBuffer[tail];
+    USART_RxTail = (tail + 1) & USART_RX_BUFFER_MASK;
+
+    if (USART_FlowStopped && USART_RxAvailable() <= USART_XON_LEVEL) {
+        USART_Resume();
+    }
+    return data;
+}
+
+uint8_t USART_RxErrors(void)
+{
+    return USART_RxLost;
+}
+
+// XON/XOFF on the receive side; disabling releases a stopped host
+void USART_SetFlowControl(const uint8_t Enable)
+{
+    USART_FlowEnabled = Enable;
+    if (!Enable && USART_FlowStopped) USART_Resume();
+}
+
+static void USART_Enqueue(const uint8_t Data)
+{
+    uint8_t head = USART_TxHead;
+
+    USART_TxBuffer[head] = Data;
+    USART_TxHead = (head + 1) & USART_TX_BUFFER_MASK;
+    USART_TxTotal++;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        USART_CLEAR_TXC();                  // Clear stale "transmit complete"
+        USART_TxSent = 1;
+        UCSRB |= (1 << UDRIE);
+    }
+}
+
+static void USART_Resume(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        USART_FlowStopped = 0;
+        USART_FlowPending = USART_XON;      // Replaces an XOFF not yet sent
+        USART_CLEAR_TXC();
+        USART_TxSent = 1;
+        UCSRB |= (1 << UDRIE);
+    }
+}
+//---------------------------//
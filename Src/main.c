@@ -13,7 +13,7 @@
     
     #include <avr/io.h>
     #include <avr/interrupt.h>
-    #include <avr/eeprom.h>
+    #include <avr/sleep.h>
     #include <util/delay.h>
     #include <util/twi.h>
     #include <stdio.h>
@@ -22,15 +22,19 @@
     #include "KS0108.h"
     #include "KS0108_Settings.h"   
     #include "Font5x8.h"
+    #include "Clock.h"
+    #include "Buzzer.h"
+    #include "Coroutine.h"
+    #include "USART.h"
+    #include "Frame.h"
+    #include "Store.h"
+    #include "Command.h"
+    #include "Roster.h"
 
     // GLCD specific settings
     #define GLCD_WIDTH      128
     #define GLCD_HEIGHT     64
 
-    // ----------------- USART Configuration -----------------
-    #define BAUD 9600
-    #define MYUBRR ((F_CPU / 16 / BAUD) - 1)
-
     // ----------------- Keypad Configuration -----------------
     #define KEYPAD_PORT PORTA
     #define KEYPAD_DDR  DDRA
@@ -51,14 +55,15 @@
     #define US_ECHO   PB1
     #define US_ERROR         -1
     #define US_NO_OBSTACLE   -2
+    #define US_ECHO_START_MAX 10000     // Timer1 counts (5 ms) for the echo to begin
 
     // ----------------- Temperature Sensor Configuration -----------------
     #define TEMP_ADC_CHANNEL 0 // Using PA0/ADC0
+    #define TEMP_SAMPLE_MS    500
+    #define TRAFFIC_SAMPLE_MS 2000
 
     // ----------------- Buzzer Configuration -----------------
-    #define BUZZER_PORT PORTD
-    #define BUZZER_DDR  DDRD
-    #define BUZZER_PIN  PD7
+    // Pins live in Buzzer.h: tones need the buzzer on OC2 (PD7)
 
 
     //-------------------- RTC Definitions --------------------
@@ -77,9 +82,6 @@
     } RTCDateTime;
 
     // ----------------- Constants -----------------
-    #define MAX_STUDENTS       20
-    #define STUDENT_ID_LENGTH  8
-    #define EEPROM_START_ADDR  0x00
     #define ATTENDANCE_TIME_LIMIT 10
     #define BUFFER_SIZE 16
 
@@ -107,49 +109,72 @@
 
 
     // -------------------Global Variables -------------------
-    volatile uint32_t systemTime = 0;
-    volatile uint32_t inputStartTime = 0;
+    uint32_t inputDeadline = 0;      // Clock_Millis() deadline for ID entry
     volatile uint8_t timeoutOccurred = 0;
 
-    uint8_t studentCount = 0;
     uint16_t attendanceStartTime = 0;
     uint8_t attendanceActive = 0;
 
+    // Latest background sensor samples
+    volatile uint16_t temperatureAdc = 0;
+    volatile uint16_t temperatureC = 0;
+    volatile uint16_t trafficDistance = (uint16_t)US_NO_OBSTACLE;
+    volatile uint8_t peopleCount = 0;
+    Timer_t temperatureTimer;
+    Timer_t trafficTimer;
+
+    // Active menu flow; only one runs at a time so they share one context
+    typedef uint8_t (*Flow_t)(void);
     typedef struct {
+        Co_t co;
+        char key;                           // Key pressed this pass, 0 if none
         char id[STUDENT_ID_LENGTH + 1];
-        uint32_t timestamp;  // Timestamp in seconds since system start
-    } StudentRecord;
-    StudentRecord presentStudents[MAX_STUDENTS];  
+        uint8_t idIndex;
+        uint32_t wait;                      // CO_SLEEP deadline
+        Co_t list;                          // flowShowRange(), run from a flow
+        StoreRange_t range;                 // Records it shows
+        StoreSync_t sync;                   // Range of the export in progress
+        uint8_t record[SYNC_RECORD_SIZE];   // Record being queued for USART
+        uint32_t txStart;                   // Export throughput measurement
+        uint32_t txBytes;
+    } FlowContext;
+    FlowContext flow;
+    Flow_t activeFlow = NULL;
 
     // ----------------- Function Declarations -----------------
     void initSystem(void);
-    void initUSART(void);
     void initGLCD(void);
     void initKeypad(void);
     void initADC(void);
     void initUltrasonic(void);
-    void initTimer0(void);
 
     void displayMenu(void);
-    void handleKeypad(void);
+    void handleKeypad(char key);
     char getKeypadInput(void);
+    uint8_t keypadActivity(void);
+    void idleUntilEvent(void);
 
     void startupBeep(void);
 
+    void startFlow(Flow_t fn);
+    void showMessage(const char *line1, const char *line2);
+    uint8_t flowTypeDigit(char key);
+    void flowShowTypedID(void);
+
     void startAttendance(void);
-    uint8_t validateStudentID(const char* id);
-    void submitStudentCode(void);
-    void searchStudent(void);
-    void viewPresentStudents(void);
-    void removeStudent(void) ;
-    void monitorTemperature(void);
-    void retrieveStudentData(void);
+    uint8_t submitStudentCode(void);
+    uint8_t searchStudent(void);
+    uint8_t viewPresentStudents(void);
+    uint8_t viewLateArrivals(void);
+    uint8_t flowShowRange(void);
+    uint8_t removeStudent(void);
+    uint8_t monitorTemperature(void);
+    uint8_t retrieveStudentData(void);
     uint8_t checkAttendanceTimeLimit(void);
-    void startAttendance(void);
-    void monitorTraffic(void);
+    uint8_t monitorTraffic(void);
 
-    void USART_Transmit(unsigned char data);
-    void USART_TransmitString(const char *str);
+    void sampleTemperature(void *arg);
+    void sampleTraffic(void *arg);
 
     uint16_t readTemperature(void);
     uint16_t measureDistance(void);
@@ -158,68 +183,26 @@
     void buzzerQuickBeep(void);
     void buzzerSuccessBeep(void);
 
-    void saveToEEPROM(void);
-    void loadFromEEPROM(void);
 
     // ----------------- System Initialization -----------------
     void initSystem(void) {
-        initUSART();
+        USART_Init();
         initGLCD();
         initKeypad();
         initADC();
         initUltrasonic();
-        initTimer0();
-        BUZZER_DDR |= (1 << BUZZER_PIN);
-        loadFromEEPROM();   
+        Clock_Init();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        Buzzer_Init();
+        Store_Load();
+        Roster_Load();
+        Timer_Start(&temperatureTimer, TEMP_SAMPLE_MS, TEMP_SAMPLE_MS, sampleTemperature, NULL);
         startupBeep();
     }
 
     void startupBeep(void) {
-    // Play three short beeps
-    for (uint8_t i = 0; i < 2; i++) {
-        BUZZER_PORT |= (1 << BUZZER_PIN); // Turn buzzer on
-        _delay_ms(200);                    // Delay for 100 ms
-        BUZZER_PORT &= ~(1 << BUZZER_PIN); // Turn buzzer off
-        _delay_ms(200);                    // Delay for 100 ms between beeps
-    }
-    
-    // Play one long beep
-    BUZZER_PORT |= (1 << BUZZER_PIN);    // Turn buzzer on
-    _delay_ms(500);                       // Delay for 500 ms
-    BUZZER_PORT &= ~(1 << BUZZER_PIN);   // Turn buzzer off
-}
-
-    // ----------------- USART -----------------
-void initUSART(void) {
-    // Set baud rate
-    UBRRL = (unsigned char)MYUBRR;
-    UBRRH = (unsigned char)(MYUBRR >> 8);
-    
-    // Enable transmitter and receiver
-    UCSRB = (1 << RXEN) | (1 << TXEN);
-    
-    // Set frame format: 8 data bits, 1 stop bit
-     UCSRC = (1 << UCSZ1) | (1 << UCSZ0);
-}
-
-void USART_Transmit(unsigned char data) {
-    // Wait for empty transmit buffer
-    while (!(UCSRA & (1 << UDRE)));
-    
-    // Put data into buffer
-    UDR = data;
-}
-
-void USART_TransmitString(const char *str) {   
-    if (!str) return;
-    
-    while (*str) {
-        USART_Transmit(*str++);
-        _delay_ms(50); // Small delay between characters
-    }
-    // Send newline
-    USART_Transmit('\r');
-    USART_Transmit('\n');
+    // Two short beeps and one long, played by Timer2 in the background
+    Buzzer_Play(&Buzzer_Startup);
 }
 
     // ----------------- LCD -----------------
@@ -282,6 +265,26 @@ char getKeypadInput(void) {
     }
     return 0;  // No key pressed
 }
+
+// Cheap "any key down" check: all rows low, look for a pulled-down column.
+// PORTA has no pin-change interrupt on the ATmega32, so the idle loop polls
+// this on every (coarse) Timer0 wake instead of doing a full scan.
+uint8_t keypadActivity(void) {
+    KEYPAD_PORT &= ~ROW_MASK;
+    _delay_us(5);
+    return ((KEYPAD_PIN & COL_MASK) >> COL_START_PIN) != 0x07;
+}
+
+    // ----------------- Power -----------------
+void idleUntilEvent(void) {
+    // Stretch the Timer0 tick up to the next armed deadline; a running
+    // command polls Clock deadlines the timer wheel does not know about
+    uint16_t next = Command_IsBusy() ? 1 : Timer_NextDelay();
+    Clock_SetTickMs(next > CLOCK_TICK_MAX_MS ? CLOCK_TICK_MAX_MS : next);
+
+    // Any interrupt (Timer0 tick, USART, ...) wakes the CPU again
+    sleep_mode();
+}
     // ----------------- ADC (Temperature) -----------------
     void initADC(void) {
         // Set AVCC as reference voltage
@@ -315,8 +318,13 @@ char getKeypadInput(void) {
         US_DDR &= ~(1 << US_ECHO);  // Echo pin input
     }
 
+// Both waits are bounded by Timer1 (prescaler 8, 0.5 us per count), so a
+// missing sensor costs 5 ms and the longest echo 30 ms
 uint16_t measureDistance(void) {
-    uint32_t i, result;
+    uint16_t result;
+
+    TCCR1A = 0x00;
+    TCCR1B = (1 << CS11);
 
     // Trigger pulse
     US_PORT |= (1 << US_TRIG);
@@ -324,92 +332,43 @@ uint16_t measureDistance(void) {
     US_PORT &= ~(1 << US_TRIG);
 
     // Wait for rising edge
-    for (i = 0; i < 600000; i++) {
-        if (US_PIN & (1 << US_ECHO)) break;
-    }
-    if (i == 600000) return US_ERROR;
-
-    // Start Timer1 with prescaler 8
-    TCCR1A = 0x00;
-    TCCR1B = (1 << CS11);
     TCNT1 = 0;
+    while (!(US_PIN & (1 << US_ECHO))) {
+        if (TCNT1 > US_ECHO_START_MAX) {
+            TCCR1B = 0x00;
+            return US_ERROR;
+        }
+    }
 
     // Wait for falling edge
-    for (i = 0; i < 600000; i++) {
-        if (!(US_PIN & (1 << US_ECHO))) break;
-        if (TCNT1 > 60000) return US_NO_OBSTACLE;
+    TCNT1 = 0;
+    while (US_PIN & (1 << US_ECHO)) {
+        if (TCNT1 > 60000) {
+            TCCR1B = 0x00;
+            return US_NO_OBSTACLE;
+        }
     }
     result = TCNT1;
     TCCR1B = 0x00;
 
-    if (result > 60000) return US_NO_OBSTACLE;
-
     // Convert to centimeters
     // Timer ticks / (58μs × 2 ticks/μs) = distance in cm
-    return (uint16_t)(result / 116);
+    return result / 116;
 }
 
     // ----------------- Buzzer -----------------
+    // Non-blocking: patterns are sequenced by Timer2, see Buzzer.c
     void buzzerBeep(void) {
-        BUZZER_PORT |= (1 << BUZZER_PIN);
-        _delay_ms(750);
-        BUZZER_PORT &= ~(1 << BUZZER_PIN);
+        Buzzer_Play(&Buzzer_Error);
     }
 
     void buzzerQuickBeep(void) {
-    BUZZER_PORT |= (1 << BUZZER_PIN);
-    _delay_ms(250);
-    BUZZER_PORT &= ~(1 << BUZZER_PIN);
-    }
-
-void buzzerSuccessBeep(void) {
-    for(uint8_t i = 0; i < 2; i++) {
-        BUZZER_PORT |= (1 << BUZZER_PIN);
-        _delay_ms(250);
-        BUZZER_PORT &= ~(1 << BUZZER_PIN);
-        _delay_ms(250);
-        }
-    }
-
-    // ----------------- EEPROM Operations -----------------
-    void saveToEEPROM(void) {
-        uint16_t addr = EEPROM_START_ADDR;
-        eeprom_write_byte((uint8_t*)addr++, studentCount);
-        for(uint8_t i = 0; i < studentCount; i++) {
-            // Valid data check
-            if(!validateStudentID(presentStudents[i].id)) {
-                    presentStudents[i].id[0] = '\0';
-                    presentStudents[i].timestamp = 0;
-            }
-
-            for(uint8_t j = 0; j < STUDENT_ID_LENGTH; j++) {
-                eeprom_write_byte((uint8_t*)addr++, presentStudents[i].id[j]);
-            }
-            eeprom_write_dword((uint32_t*)addr, presentStudents[i].timestamp);
-            addr += sizeof(uint32_t);
-        }
-    }
-
-void loadFromEEPROM(void) {
-    // First clear all records
-    for(uint8_t i = 0; i < MAX_STUDENTS; i++) {
-        presentStudents[i].id[0] = '\0';
-        presentStudents[i].timestamp = 0;
+        Buzzer_Play(&Buzzer_Quick);
     }
 
-    uint16_t addr = EEPROM_START_ADDR;
-    studentCount = eeprom_read_byte((const uint8_t*)addr++);
-    if (studentCount > MAX_STUDENTS) studentCount = 0;
-
-    for(uint8_t i = 0; i < studentCount; i++) {
-        for(uint8_t j = 0; j < STUDENT_ID_LENGTH; j++) {
-            presentStudents[i].id[j] = eeprom_read_byte((const uint8_t*)addr++);
-        }
-        presentStudents[i].id[STUDENT_ID_LENGTH] = '\0';
-        presentStudents[i].timestamp = eeprom_read_dword((const uint32_t*)addr);
-        addr += sizeof(uint32_t);
+    void buzzerSuccessBeep(void) {
+        Buzzer_Play(&Buzzer_Success);
     }
-}
 
     // ----------------- Menu & Logic -----------------
     void displayMenu(void) {
@@ -443,6 +402,8 @@ void loadFromEEPROM(void) {
                 GLCD_GotoXY(0,16);
                 GLCD_PrintString("3:Remove Student");
                 GLCD_GotoXY(0,24);
+                GLCD_PrintString("4:Late Arrivals");
+                GLCD_GotoXY(0,32);
                 GLCD_PrintString("*:Back");
                 break;
                 
@@ -470,16 +431,13 @@ void loadFromEEPROM(void) {
         previousMenu = currentMenu;
     }
 
-void handleKeypad(void) {
-    char key = getKeypadInput();
-    if(!key) return;
-
+void handleKeypad(char key) {
     switch(currentMenu) {
         case MENU_MAIN:
             if(key == '1') {
                 currentMenu = MENU_ATTENDANCE;
                 displayMenu();
-                submitStudentCode(); 
+                startFlow(submitStudentCode);
             }
             else if(key == '2') {
                 currentMenu = MENU_STUDENT_MGMT;
@@ -488,17 +446,17 @@ void handleKeypad(void) {
             else if(key == '3') {
                 currentMenu = MENU_TEMP_MONITOR;
                 displayMenu();
-                monitorTemperature(); 
+                startFlow(monitorTemperature);
             }
             else if(key == '4') {
                 currentMenu = MENU_RETRIEVE_DATA;
                 displayMenu();
-                retrieveStudentData(); 
+                startFlow(retrieveStudentData);
             }
             else if(key == '5') {
                 currentMenu = MENU_TRAFFIC;
                 displayMenu();
-                monitorTraffic();
+                startFlow(monitorTraffic);
             }
             break;
 
@@ -509,13 +467,16 @@ void handleKeypad(void) {
                 displayMenu();
             } 
             else if(key == '1') {
-                searchStudent();
+                startFlow(searchStudent);
             } 
             else if(key == '2') {      
-                viewPresentStudents();  
+                startFlow(viewPresentStudents);
             }
             else if(key == '3') {
-                removeStudent();
+                startFlow(removeStudent);
+            }
+            else if(key == '4') {
+                startFlow(viewLateArrivals);
             }
             break;
 
@@ -528,30 +489,54 @@ void handleKeypad(void) {
     }
 }
 
-    void initTimer0(void) {
-        // Setup Timer0 for 1ms interrupts
-        TCCR0 = (1 << WGM01) | (1 << CS02);  // CTC mode, prescaler 256
-        OCR0 = 62;  // For 1ms interrupt at 16MHz
-        TIMSK |= (1 << OCIE0);  // Enable compare match interrupt
-        sei();  // Enable global interrupts
+    // ----------------- Flows -----------------
+    // Menu flows are coroutines (see Coroutine.h). The main loop calls the
+    // active one once per pass with the newly pressed key in flow.key, so
+    // background timers keep running while a flow waits for input.
+void startFlow(Flow_t fn) {
+    CO_INIT(&flow.co);
+    CO_INIT(&flow.list);
+    flow.key = 0;
+    flow.idIndex = 0;
+    memset(flow.id, 0, sizeof(flow.id));
+    activeFlow = fn;
+}
+
+void showMessage(const char *line1, const char *line2) {
+    GLCD_Clear();
+    GLCD_GotoXY(1, 1);
+    GLCD_PrintString(line1);
+    if(line2) {
+        GLCD_GotoXY(1, 9);
+        GLCD_PrintString(line2);
+    }
+    GLCD_Render();
+}
+
+// Appends a digit to flow.id, returns 1 if the key was consumed
+uint8_t flowTypeDigit(char key) {
+    if(key >= '0' && key <= '9' && flow.idIndex < STUDENT_ID_LENGTH) {
+        flow.id[flow.idIndex++] = key;
+        flow.id[flow.idIndex] = '\0';
+        return 1;
     }
+    return 0;
+}
 
-    // Timer0 interrupt for system time
-    ISR(TIMER0_COMP_vect) {
-        static uint16_t ms_counter = 0;
-        ms_counter++;
-        if (ms_counter >= 1000) {  // 1 second passed
-            systemTime++;
-            ms_counter = 0;
-        }
+void flowShowTypedID(void) {
+    GLCD_GotoXY(1, 8);  // Position after "Enter ID:"
+    GLCD_PrintString(flow.id);
+    // Add cursor position indicator
+    if(flow.idIndex < STUDENT_ID_LENGTH) {
+        GLCD_PrintString("_");
     }
+    GLCD_Render();
+}
 
-void searchStudent(void) {
-    char searchID[STUDENT_ID_LENGTH + 1] = {0};
-    uint8_t idIndex = 0;
-    char key;
-    uint8_t found = 0;
+uint8_t searchStudent(void) {
+    Co_t *co = &flow.co;
 
+    CO_BEGIN(co);
     GLCD_Clear();
     GLCD_GotoXY(1, 1);
     GLCD_PrintString("Enter ID:");
@@ -560,87 +545,135 @@ void searchStudent(void) {
     GLCD_Render();
 
     while(1) {
-        key = getKeypadInput();
-        if(key) {
-            if(key == '*') {
-                currentMenu = MENU_STUDENT_MGMT;
-                return;
-            }
-            if((key >= '0' && key <= '9') && idIndex < STUDENT_ID_LENGTH) {
-                searchID[idIndex++] = key;
-                searchID[idIndex] = '\0';
-                GLCD_GotoXY(1, 8);
-                GLCD_GotoXY(1, 8);  // Position after "Enter ID:"
-                GLCD_PrintString(searchID);
-                // Add cursor position indicator
-                if(idIndex < STUDENT_ID_LENGTH) {
-                    GLCD_PrintString("_");
-                }
+        CO_WAIT_UNTIL(co, flow.key);
+        if(flow.key == '*') {
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
+        }
+        if(flowTypeDigit(flow.key)) {
+            flowShowTypedID();
+        }
+        if(flow.key == '#' && flow.idIndex == STUDENT_ID_LENGTH) {
+            int16_t index = Store_Find(flow.id);
+            if(index >= 0) {
+                uint32_t timestamp = Store_RecordTime(index);
+                char id[STUDENT_ID_LENGTH + 1];
+                Store_RecordID(index, id);
+                GLCD_Clear();
+                GLCD_GotoXY(1, 1);
+                GLCD_PrintString("Found:");
+                GLCD_GotoXY(1, 9);
+                GLCD_PrintString(id);
+                GLCD_GotoXY(1, 17);
+                uint8_t hours = (timestamp / 3600) % 24;
+                uint8_t minutes = (timestamp / 60) % 60;
+                char timeStr[BUFFER_SIZE];
+                snprintf(timeStr, sizeof(timeStr), "Time: %02u:%02u", hours, minutes);
+                GLCD_PrintString(timeStr);
                 GLCD_Render();
+            } else {
+                showMessage("No Record", "Exists!");
             }
-            if(key == '#' && idIndex == STUDENT_ID_LENGTH) {
-                for(uint8_t i = 0; i < studentCount; i++) {
-                    if(strncmp(searchID, presentStudents[i].id, STUDENT_ID_LENGTH) == 0) {
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Found:");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString(presentStudents[i].id);
-                        GLCD_GotoXY(1, 17);
-                        uint8_t hours = (presentStudents[i].timestamp / 3600) % 24;
-                        uint8_t minutes = (presentStudents[i].timestamp / 60) % 60;
-                        char timeStr[BUFFER_SIZE];
-                        snprintf(timeStr, sizeof(timeStr), "Time: %02u:%02u", hours, minutes);
-                        GLCD_PrintString(timeStr);
-                        GLCD_Render();
-                        found = 1;
-                        break;
-                    }
-                }
-                if(!found) {
-                    GLCD_Clear();
-                    GLCD_GotoXY(1, 1);
-                    GLCD_PrintString("No Record");
-                    GLCD_GotoXY(1, 9);
-                    GLCD_PrintString("Exists!");
-                    GLCD_Render();
-                }
-                _delay_ms(2000);
-                currentMenu = MENU_STUDENT_MGMT;
-                return;
-            }
+            CO_SLEEP(co, flow.wait, 2000);
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
         }
-        _delay_ms(500);
     }
+    CO_END(co);
 }
 
 
-void viewPresentStudents(void) {
-    char buffer[BUFFER_SIZE];
+uint8_t viewPresentStudents(void) {
+    Co_t *co = &flow.co;
 
-    if(studentCount == 0) {
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString_P("No Students Present");
-        GLCD_Render();
+    CO_BEGIN(co);
+    if(Store_Count() == 0) {
+        showMessage("No Students Present", NULL);
         buzzerQuickBeep();
-        _delay_ms(1000);
-        return;
+        CO_SLEEP(co, flow.wait, 1000);
+        CO_EXIT(co);
+    }
+
+    Store_RangeBegin(&flow.range, 0, STORE_TIME_END);
+    CO_WAIT_UNTIL(co, flowShowRange() == CO_DONE);
+    CO_END(co);
+}
+
+// Students who checked in at or after an hh:mm typed on the keypad
+uint8_t viewLateArrivals(void) {
+    Co_t *co = &flow.co;
+
+    CO_BEGIN(co);
+    GLCD_Clear();
+    GLCD_GotoXY(1, 1);
+    GLCD_PrintString("Late after hhmm:");
+    GLCD_GotoXY(1, 16);
+    GLCD_PrintString("*:Back #:Submit");
+    GLCD_Render();
+
+    while(1) {
+        CO_WAIT_UNTIL(co, flow.key);
+        if(flow.key == '*') {
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
+        }
+        if(flow.idIndex < 4 && flowTypeDigit(flow.key)) {
+            flowShowTypedID();
+        }
+        if(flow.key == '#' && flow.idIndex == 4) {
+            uint8_t hours = (flow.id[0] - '0') * 10 + (flow.id[1] - '0');
+            uint8_t minutes = (flow.id[2] - '0') * 10 + (flow.id[3] - '0');
+
+            if(hours < 24 && minutes < 60) {
+                // On today's clock, as RANGE; the range binary-searches to the first one
+                Store_RangeBegin(&flow.range, Clock_TimeToday(hours, minutes, 0), STORE_TIME_END);
+                break;
+            }
+            showMessage("Invalid Time!", NULL);
+            CO_SLEEP(co, flow.wait, 1000);
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
+        }
     }
 
-    for(uint8_t i = 0; i < studentCount; i++) {
-        // Valid data check
-        if(!validateStudentID(presentStudents[i].id)) {
-            continue;
+    if(Store_RangeCount(&flow.range) == 0) {
+        showMessage("No Late Arrivals", NULL);
+        CO_SLEEP(co, flow.wait, 1000);
+        currentMenu = MENU_STUDENT_MGMT;
+        CO_EXIT(co);
+    }
+    CO_WAIT_UNTIL(co, flowShowRange() == CO_DONE);
+    currentMenu = MENU_STUDENT_MGMT;
+    CO_END(co);
+}
+
+// Shows the records of flow.range one by one. Run from a flow with
+// CO_WAIT_UNTIL; the range holds its place, not an index, so
+// check-ins and compaction meanwhile do no harm.
+uint8_t flowShowRange(void) {
+    Co_t *co = &flow.list;
+    char buffer[BUFFER_SIZE];
+
+    CO_BEGIN(co);
+    while(1) {
+        int16_t index = Store_RangeNext(&flow.range);
+        if(index < 0) {
+            break;
         }
 
+        uint32_t timestamp = Store_RecordTime(index);
+        char id[STUDENT_ID_LENGTH + 1];
+
+        // Records are packed, every one decodes to a valid ID
+        Store_RecordID(index, id);
+
         GLCD_Clear();
         GLCD_GotoXY(0, 0);
         GLCD_PrintString("ID:");
-        GLCD_PrintString(presentStudents[i].id);
+        GLCD_PrintString(id);
 
-        uint8_t hours = (presentStudents[i].timestamp / 3600) % 24;
-        uint8_t minutes = (presentStudents[i].timestamp / 60) % 60;
+        uint8_t hours = (timestamp / 3600) % 24;
+        uint8_t minutes = (timestamp / 60) % 60;
         snprintf(buffer, sizeof(buffer), "%02u:%02u", hours, minutes);
 
         GLCD_GotoXY(0, 16);
@@ -648,16 +681,15 @@ void viewPresentStudents(void) {
         GLCD_PrintString(buffer);
         GLCD_Render();
 
-        _delay_ms(500);
+        CO_SLEEP(co, flow.wait, 500);
     }
+    CO_END(co);
 }
 
-void removeStudent(void) {
-    char removeID[STUDENT_ID_LENGTH + 1] = {0};
-    uint8_t idIndex = 0;
-    char key;
-    uint8_t removed = 0;
+uint8_t removeStudent(void) {
+    Co_t *co = &flow.co;
 
+    CO_BEGIN(co);
     GLCD_Clear();
     GLCD_GotoXY(1, 1);
     GLCD_PrintString("Remove Student");
@@ -666,197 +698,153 @@ void removeStudent(void) {
     GLCD_Render();
 
     while(1) {
-        key = getKeypadInput();
-        if(key) {
-            if(key == '*') {
-                currentMenu = MENU_STUDENT_MGMT;
-                return;
-            }
-            if(key >= '0' && key <= '9' && idIndex < STUDENT_ID_LENGTH) {
-                removeID[idIndex++] = key;
-                removeID[idIndex] = '\0';
-                GLCD_GotoXY(1, 8);  // Position after "Enter ID:"
-                GLCD_PrintString(removeID);
-                // Add cursor position indicator
-                if(idIndex < STUDENT_ID_LENGTH) {
-                    GLCD_PrintString("_");
-                }
-                GLCD_Render();
-            }
-            if(key == '#' && idIndex == STUDENT_ID_LENGTH) {
-                for(uint8_t i = 0; i < studentCount; i++) {
-                    if(strcmp(removeID, presentStudents[i].id) == 0) {
-                        // Shift array left
-                        for(uint8_t j = i; j < studentCount - 1; j++) {
-                            presentStudents[j] = presentStudents[j + 1];
-                        }
-                        studentCount--;
-                        saveToEEPROM();
-                        removed = 1;
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Student");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString("Removed!");
-                        GLCD_Render();
-                        _delay_ms(3000);
-                        break;
-                    }
-                }
-                if(!removed) {
-                    GLCD_Clear();
-                    GLCD_GotoXY(1, 1);
-                    GLCD_PrintString("ID not found!");
-                    GLCD_Render();
-                    _delay_ms(3000);
-                }
-                currentMenu = MENU_STUDENT_MGMT;
-                return;
+        CO_WAIT_UNTIL(co, flow.key);
+        if(flow.key == '*') {
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
+        }
+        if(flowTypeDigit(flow.key)) {
+            flowShowTypedID();
+        }
+        if(flow.key == '#' && flow.idIndex == STUDENT_ID_LENGTH) {
+            if(Store_Remove(flow.id) == STORE_OK) {
+                showMessage("Student", "Removed!");
+            } else {
+                showMessage("ID not found!", NULL);
             }
+            CO_SLEEP(co, flow.wait, 3000);
+            currentMenu = MENU_STUDENT_MGMT;
+            CO_EXIT(co);
         }
-        _delay_ms(500);
     }
+    CO_END(co);
 }
 
-void monitorTemperature(void) {
-        char key;
-        uint16_t raw_adc;
-        uint16_t temp;
-        char tempStr[BUFFER_SIZE];
-        
-        // Select ADC channel 0 with left adjust result
-        ADMUX = (1 << REFS0) | (0 & 0x07);
-        
-        // Initial display setup
+    // ----------------- Background sampling -----------------
+    // Driven by the timer wheel. Temperature is sampled whatever is on
+    // screen; the ultrasonic sensor only while the traffic monitor runs.
+void sampleTemperature(void *arg) {
+    (void)arg;
+
+    // Select ADC channel 0
+    ADMUX = (1 << REFS0) | (TEMP_ADC_CHANNEL & 0x07);
+
+    // Start conversion
+    ADCSRA |= (1 << ADSC);
+    while (ADCSRA & (1 << ADSC)); // Wait for conversion
+    temperatureAdc = ADC;
+
+    // Convert to temperature (LM35: 10mV/°C)
+    uint16_t millivolts = (temperatureAdc * 5000.0) / 1024.0;
+    temperatureC = millivolts / 10;
+}
+
+void sampleTraffic(void *arg) {
+    (void)arg;
+
+    trafficDistance = measureDistance();
+
+    // Only count when person moves away (to avoid multiple counts)
+    if(trafficDistance <= 3) {
+        peopleCount++;
+        buzzerQuickBeep();
+    }
+}
+
+uint8_t monitorTemperature(void) {
+    Co_t *co = &flow.co;
+    char tempStr[BUFFER_SIZE];
+
+    CO_BEGIN(co);
+    while(1) {
         GLCD_Clear();
         GLCD_GotoXY(1, 1);
         GLCD_PrintString("Temperature:");
+
+        // Display latest readings
+        snprintf(tempStr, sizeof(tempStr), "ADC:%u", temperatureAdc);
+        GLCD_GotoXY(1, 9);
+        GLCD_PrintString(tempStr);
+
+        snprintf(tempStr, sizeof(tempStr), "Temp:%u.0C", temperatureC);
+        GLCD_GotoXY(1, 17);
+        GLCD_PrintString(tempStr);
+
         GLCD_GotoXY(1, 25);
         GLCD_PrintString("*:Back");
         GLCD_Render();
 
-        while(1) {
-            GLCD_PrintString("Temperature:");
-            GLCD_GotoXY(1, 25);
-            GLCD_PrintString("*:Back");
-            key = getKeypadInput();
-            if(key == '*') {
-                currentMenu = MENU_MAIN;
-                return;
-            }
-
-            // Start conversion
-            ADCSRA |= (1 << ADSC);
-            while (ADCSRA & (1 << ADSC)); // Wait for conversion
-            raw_adc = ADC;
-            
-            // Convert to temperature (LM35: 10mV/°C)
-            temp = (raw_adc * 5000.0) / 1024.0;  // Convert to millivolts
-            temp = temp / 10.0;  // Convert to Celsius
-            
-            // Clear previous readings
-            GLCD_Clear();
-            // Display readings
-            snprintf(tempStr, sizeof(tempStr), "ADC:%u", raw_adc);
-            GLCD_GotoXY(1, 9);
-            GLCD_PrintString(tempStr);
-            
-            snprintf(tempStr, sizeof(tempStr), "Temp:%d.%dC", 
-                    (int)temp, (int)((temp - (int)temp) * 10));
-            GLCD_GotoXY(1, 17);
-            GLCD_PrintString(tempStr);
-            
-            GLCD_Render();
-            _delay_ms(500);
+        flow.wait = Clock_Deadline(TEMP_SAMPLE_MS);
+        CO_WAIT_UNTIL(co, flow.key == '*' || Clock_Expired(flow.wait));
+        if(flow.key == '*') {
+            currentMenu = MENU_MAIN;
+            CO_EXIT(co);
         }
+    }
+    CO_END(co);
 }
 
-    void retrieveStudentData(void) {
-        char buffer[BUFFER_SIZE];
-        uint8_t i;
-
-        // Show we're starting
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString("Sending...");
-        GLCD_Render();
-        _delay_ms(1000);  // Give time for display
+// Sends all records as one binary frame (see Frame.h), yielding while
+// the TX ring is full so the UI stays live during the transfer
+uint8_t retrieveStudentData(void) {
+    Co_t *co = &flow.co;
+    char buffer[BUFFER_SIZE];
 
-        // Test USART first
-        USART_TransmitString("=== START ===");
-        _delay_ms(1000);
+    CO_BEGIN(co);
+    // Show we're starting
+    showMessage("Sending...", NULL);
+    flow.txStart = Clock_Micros();
+    flow.txBytes = USART_TxCount();
+
+    // Don't interleave with a command reply on the same wire
+    CO_WAIT_UNTIL(co, !Command_IsBusy() && Frame_IsReady());
+    // Only what changed since the host's last ACK (see Store.h), counted
+    // with no yield before the header goes out
+    Store_SyncBegin(&flow.sync, 0);
+    CO_WAIT_UNTIL(co, Frame_TryBegin(FRAME_TYPE_SYNC, SYNC_SCHEMA_VERSION, flow.sync.Count));
+
+    // Walks by sequence number, so check-ins meanwhile shift nothing
+    while(Store_SyncNext(&flow.sync, flow.record)) {
+        CO_WAIT_UNTIL(co, Frame_TryWrite(flow.record, SYNC_RECORD_SIZE));
+    }
 
-        // Display student count
-        snprintf(buffer, sizeof(buffer), "Students: %d", studentCount);
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString(buffer);
-        GLCD_Render();
-        USART_TransmitString(buffer);
-        _delay_ms(1000);
+    // A change lost meanwhile went out as padding: the host drops it
+    if(flow.sync.Short) {
+        CO_WAIT_UNTIL(co, Frame_TryAbort());
+    } else {
+        CO_WAIT_UNTIL(co, Frame_TryEnd());
+    }
+    CO_WAIT_UNTIL(co, USART_TxDone());
 
-        // Send each student's data
-        for(i = 0; i < studentCount; i++) {
-            // Valid data check
-            if(!validateStudentID(presentStudents[i].id)) {
-                continue;
-            }
+    // Show completion and achieved throughput
+    flow.txBytes = USART_TxCount() - flow.txBytes;
+    flow.txStart = (Clock_Micros() - flow.txStart) / 100;  // Elapsed in 100 us units
 
-            // Clear previous
-            GLCD_Clear();
-
-                        // Send to USART
-            snprintf(buffer, sizeof(buffer), "ID:%s", 
-                    presentStudents[i].id);
-            USART_TransmitString(buffer);
-            
-            // Format student data
-            uint8_t hours = (presentStudents[i].timestamp / 3600) % 24;
-            uint8_t minutes = (presentStudents[i].timestamp / 60) % 60;
-            
-            // Show on LCD
-            GLCD_GotoXY(1, 1);
-            GLCD_PrintString(presentStudents[i].id);
-            snprintf(buffer, sizeof(buffer), "Time: %02u:%02u", hours, minutes);
-            GLCD_GotoXY(1, 9);
-            GLCD_PrintString(buffer);
-            GLCD_Render();
-            USART_TransmitString(buffer);
-            
-            _delay_ms(1000);  // Show each record for 1 second
-        }
+    GLCD_Clear();
+    GLCD_GotoXY(1, 1);
+    GLCD_PrintString("Data Sent!");
+    GLCD_GotoXY(1, 9);
+    snprintf(buffer, sizeof(buffer), "%s:%u", flow.sync.Full ? "Records" : "Changes",
+            flow.sync.Count - 1);
+    GLCD_PrintString(buffer);
+    GLCD_GotoXY(1, 17);
+    snprintf(buffer, sizeof(buffer), "%lu B/s",
+            flow.txStart ? flow.txBytes * 10000UL / flow.txStart : 0UL);
+    GLCD_PrintString(buffer);
+    GLCD_Render();
+    CO_SLEEP(co, flow.wait, 2000);
 
-        // Show completion
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString("Data Sent!");
-        GLCD_GotoXY(1, 9);
-        GLCD_PrintString("Records:");
-        snprintf(buffer, sizeof(buffer), "%d", studentCount);
-        GLCD_GotoXY(1, 17);
-        GLCD_PrintString(buffer);
-        GLCD_Render();
-        
-        USART_TransmitString("=== END ===");
-        _delay_ms(2000);
-        
-        currentMenu = MENU_MAIN;
-    }
+    currentMenu = MENU_MAIN;
+    CO_END(co);
+}
 
+    // Returns 0 (and shows the message) once the ID entry deadline passed
     uint8_t checkAttendanceTimeLimit(void) {
         if (!attendanceActive) return 1;
 
-        uint32_t elapsedTime = systemTime - inputStartTime;
-        
-        if (elapsedTime >= ATTENDANCE_TIME_LIMIT) {
-            GLCD_Clear();
-            GLCD_GotoXY(1, 1);
-            GLCD_PrintString("Time Limit");
-            GLCD_GotoXY(1, 9);
-            GLCD_PrintString("Exceeded!");
-            GLCD_Render();
+        if (Clock_Expired(inputDeadline)) {
+            showMessage("Time Limit", "Exceeded!");
             buzzerBeep();
-            _delay_ms(2000);
             timeoutOccurred = 1;
             return 0;
         }
@@ -866,49 +854,24 @@ void monitorTemperature(void) {
     void startAttendance(void) {
         attendanceActive = 1;
         attendanceStartTime = 0;  // Current time
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString("Attendance");
-        GLCD_GotoXY(1, 9);
-        GLCD_PrintString("Started!");
-        GLCD_Render();
+        showMessage("Attendance", "Started!");
         _delay_ms(1000);
     }
 
-void monitorTraffic(void) {
-    uint16_t dist;
+uint8_t monitorTraffic(void) {
+    Co_t *co = &flow.co;
     char distStr[BUFFER_SIZE];
-    uint8_t peopleCount = 0;
-    char key;
-    
-    GLCD_Clear();
-    GLCD_GotoXY(0, 0);
-    GLCD_PrintString("Traffic Monitor");
-    GLCD_GotoXY(0, 8);
-    GLCD_PrintString("*:Back");
-    GLCD_Render();
 
+    CO_BEGIN(co);
+    // The sensor is only polled while this screen is up
+    Timer_Start(&trafficTimer, 0, TRAFFIC_SAMPLE_MS, sampleTraffic, NULL);
     while(1) {
-        key = getKeypadInput();
-        if(key == '*') {
-            currentMenu = MENU_MAIN;
-            return;
-        }
-
-        dist = measureDistance();
-        
-        // Only count when person moves away (to avoid multiple counts)
-        if(dist <= 3) {
-            peopleCount++;
-            buzzerQuickBeep();
-        }
-
         GLCD_Clear();
         GLCD_GotoXY(0, 0);
         GLCD_PrintString("Traffic Monitor");
         
-        if(dist != (uint16_t)US_ERROR && dist != (uint16_t)US_NO_OBSTACLE) {
-            snprintf(distStr, sizeof(distStr), "Dist:%u m", dist);
+        if(trafficDistance != (uint16_t)US_ERROR && trafficDistance != (uint16_t)US_NO_OBSTACLE) {
+            snprintf(distStr, sizeof(distStr), "Dist:%u m", trafficDistance);
             GLCD_GotoXY(0, 16);
             GLCD_PrintString(distStr);
         } else {
@@ -924,257 +887,115 @@ void monitorTraffic(void) {
         GLCD_PrintString("*:Back");
         GLCD_Render();
 
-        _delay_ms(2000); // 2 second delay between readings
+        flow.wait = Clock_Deadline(TRAFFIC_SAMPLE_MS);
+        CO_WAIT_UNTIL(co, flow.key == '*' || Clock_Expired(flow.wait));
+        if(flow.key == '*') {
+            Timer_Stop(&trafficTimer);
+            currentMenu = MENU_MAIN;
+            CO_EXIT(co);
+        }
     }
+    CO_END(co);
 }
-    uint8_t validateStudentID(const char* id) {
-        // Validate year (20-23)
-        if (id[0] != '2') return 0;
-        if (id[1] < '0' || id[1] > '3') return 0;
-        
-            // Validate department (001-999)
-            if (id[2] < '0' || id[2] > '9') return 0;
-            if (id[3] < '0' || id[3] > '9') return 0;
-            if (id[4] < '0' || id[4] > '9') return 0;
-            if (id[2] == '0' && id[3] == '0' && id[4] == '0') return 0;
-            
-            // Validate student number (001-999)
-            if (id[5] < '0' || id[5] > '9') return 0;
-            if (id[6] < '0' || id[6] > '9') return 0;
-            if (id[7] < '0' || id[7] > '9') return 0;
-            if (id[5] == '0' && id[6] == '0' && id[7] == '0') return 0;
-            
-        return 1;
+    void submitStudentDrawPrompt(void) {
+        GLCD_Clear();
+        GLCD_GotoXY(1, 1);
+        GLCD_PrintString("Enter ID:");
+        flowShowTypedID();
     }
 
-    void submitStudentCode(void) {
-        char studentID[STUDENT_ID_LENGTH + 1] = {0};
-        uint8_t idIndex = 0;
-        char key;
-        uint8_t updateDisplay = 1;
-        static uint32_t lastTimeUpdate = 0;
+    uint8_t submitStudentCode(void) {
+        Co_t *co = &flow.co;
 
+        CO_BEGIN(co);
         // Start timing
         attendanceActive = 1;
-        inputStartTime = systemTime;
+        inputDeadline = Clock_Deadline(ATTENDANCE_TIME_LIMIT * 1000UL);
         timeoutOccurred = 0;
-        char timeStr[16];
-        
-        
-        // Clear screen and show initial prompt
-        GLCD_Clear();
-        GLCD_GotoXY(1, 1);
-        GLCD_PrintString("Enter ID:");
-        GLCD_Render();
+        submitStudentDrawPrompt();
 
         while(1) {
+            // Wait for a key or the entry deadline
+            CO_WAIT_UNTIL(co, flow.key || Clock_Expired(inputDeadline));
 
             // Check for timeout
             if (!checkAttendanceTimeLimit()) {
+                CO_SLEEP(co, flow.wait, 2000);
+                attendanceActive = 0;
                 currentMenu = MENU_MAIN;
-                return;
-            }
-            key = getKeypadInput();
-            
-            // Update display if needed
-            if(updateDisplay) {
-                if(systemTime != lastTimeUpdate) {
-                    lastTimeUpdate = systemTime;
-                    
-                    // Calculate and display remaining time
-                    uint8_t remainingTime = ATTENDANCE_TIME_LIMIT - (systemTime - inputStartTime);
-                    if(remainingTime > ATTENDANCE_TIME_LIMIT) {
-                        remainingTime = 0; // Handle overflow
-                    }
-                    snprintf(timeStr, sizeof(timeStr), "Time Limit: %d s", remainingTime);
-                }
-                GLCD_Clear();
-                GLCD_GotoXY(1, 1);
-                GLCD_PrintString("Enter ID:");
-                GLCD_Render();
-                GLCD_GotoXY(1, 8);  // Position after "Enter ID:"
-                GLCD_PrintString(studentID);
-                // Add cursor position indicator
-                if(idIndex < STUDENT_ID_LENGTH) {
-                    GLCD_PrintString("_");
-                }
-                // Display remaining time
-                // GLCD_GotoXY(1, 17);
-                // GLCD_ClearLine(2);
-                // GLCD_PrintString(timeStr);
-                
-                GLCD_Render();
-                updateDisplay = 0;
+                CO_EXIT(co);
             }
 
-            if(key) {
-                // Reset timeout counter on valid input
-                inputStartTime = systemTime;
-                lastTimeUpdate = systemTime - 1; // Force immediate time update
-                updateDisplay = 1;
-                // Handle backspace (*) - clear last character
-                if(key == '*') {
-                    attendanceActive = 0;
-                // currentMenu = MENU_MAIN;
-                    if(idIndex > 0) {
-                        studentID[--idIndex] = '\0';
-                        updateDisplay = 1;
-                        
-                        // Clear the line
-                        GLCD_GotoXY(1, 8);
-                        GLCD_PrintString("        ");  // 8 spaces
-                        GLCD_Render();
-                    } else {
-                        currentMenu = MENU_MAIN;
-                        return;  // Exit if no characters to delete
-                    }
-                    continue;
-                }
+            // Reset timeout counter on valid input
+            inputDeadline = Clock_Deadline(ATTENDANCE_TIME_LIMIT * 1000UL);
 
-                // Handle number input
-                if(key >= '0' && key <= '9' && idIndex < STUDENT_ID_LENGTH) {
-                    studentID[idIndex++] = key;
-                    studentID[idIndex] = '\0';
-                    updateDisplay = 1;
+            // Handle backspace (*) - clear last character
+            if(flow.key == '*') {
+                if(flow.idIndex > 0) {
+                    flow.id[--flow.idIndex] = '\0';
+                    submitStudentDrawPrompt();
+                    continue;
                 }
+                attendanceActive = 0;
+                currentMenu = MENU_MAIN;
+                CO_EXIT(co);  // Exit if no characters to delete
+            }
 
-                // Handle submission (#)
-                if(key == '#') {
-                    // Check if ID is complete
-                    if(idIndex != STUDENT_ID_LENGTH) {
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("ID must be");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString("8 digits!");
-                        GLCD_Render();
-                        buzzerBeep();
-                        _delay_ms(2000);
-                        
-                        // Reset input
-                        idIndex = 0;
-                        memset(studentID, 0, sizeof(studentID));
-                        
-                        // Show input prompt again
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Enter ID:");
-                        GLCD_Render();
-                        updateDisplay = 1;
-                        continue;
-                    }
-
-                    // Validate ID format
-                    if(!validateStudentID(studentID)) {
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Invalid ID");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString("Format!");
-                        GLCD_Render();
-                        buzzerBeep();
-                        _delay_ms(2000);
-                        
-                        // Reset input
-                        idIndex = 0;
-                        memset(studentID, 0, sizeof(studentID));
-                        
-                        // Show input prompt again
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Enter ID:");
-                        GLCD_Render();
-                        updateDisplay = 1;
-                        continue;
-                    }
-
-                    // Check for duplicates 
-                    uint8_t isDuplicate = 0;
-                    for(uint8_t i = 0; i < studentCount; i++) {
-                        if(strcmp(studentID, presentStudents[i].id) == 0) {
-                            isDuplicate = 1;
-                            break;
-                        }
-                    }
-
-                    if(isDuplicate) {
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Already");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString("Present!");
-                        GLCD_Render();
-                        buzzerBeep();
-                        _delay_ms(2000);
-                        // Reset input
-                        idIndex = 0;
-                        memset(studentID, 0, sizeof(studentID));
-                        
-                        // Show input prompt again
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Enter ID:");
-                        GLCD_Render();
-                        updateDisplay = 1;
-                        continue;
-                    }
+            // Handle number input
+            if(flowTypeDigit(flow.key)) {
+                submitStudentDrawPrompt();
+                continue;
+            }
 
-                    // Add new student if space available
-                    if(studentCount >= MAX_STUDENTS) {
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Maximum");
-                        GLCD_GotoXY(1, 9);
-                        GLCD_PrintString("Reached!");
-                        GLCD_Render();
-                        buzzerBeep();
-                        _delay_ms(2000);
-                        // Reset input
-                        idIndex = 0;
-                        memset(studentID, 0, sizeof(studentID));
-                        
-                        // Show input prompt again
-                        GLCD_Clear();
-                        GLCD_GotoXY(1, 1);
-                        GLCD_PrintString("Enter ID:");
-                        GLCD_Render();
-                        updateDisplay = 1;
-                        continue;
-                    }
+            if(flow.key != '#') {
+                continue;
+            }
 
-                    // Add student and save to EEPROM
-                    strcpy(presentStudents[studentCount].id, studentID);
-                    presentStudents[studentCount].id[STUDENT_ID_LENGTH] = '\0';
-                    presentStudents[studentCount].timestamp = systemTime;
-                    studentCount++;
-                    
-                    // Save to EEPROM immediately
-                    saveToEEPROM();
-
-                    // Show success message
-                    GLCD_Clear();
-                    GLCD_GotoXY(1, 1);
-                    GLCD_PrintString("Attendance");
-                    GLCD_GotoXY(1, 9);
-                    GLCD_PrintString("Recorded!");
-                    GLCD_Render();
-                    buzzerSuccessBeep();  // Success beep
-                    idIndex = 0;
-                    memset(studentID, 0, sizeof(studentID));
-                    currentMenu = MENU_ATTENDANCE;
-                    _delay_ms(2000);
-                    return;
+            // Handle submission (#): check length, format, duplicates, space
+            const char *error1 = NULL;
+            const char *error2 = NULL;
+
+            if(flow.idIndex != STUDENT_ID_LENGTH) {
+                error1 = "ID must be";
+                error2 = "8 digits!";
+            } else {
+                // Add student and save to EEPROM
+                switch(Store_Add(flow.id, Clock_Seconds())) {
+                    case STORE_INVALID:
+                        error1 = "Invalid ID";
+                        error2 = "Format!";
+                        break;
+                    case STORE_DUPLICATE:
+                        error1 = "Already";
+                        error2 = "Present!";
+                        break;
+                    case STORE_FULL:
+                        error1 = "Maximum";
+                        error2 = "Reached!";
+                        break;
+                    default:
+                        break;
                 }
-            // Update display every second for countdown
-            static uint32_t lastUpdate = 0;
-            if(systemTime != lastUpdate) {
-                lastUpdate = systemTime;
-                updateDisplay = 1;
             }
-            _delay_ms(100);  // Debounce delay
-        }
 
+            if(error1) {
+                showMessage(error1, error2);
+                buzzerBeep();
+                CO_SLEEP(co, flow.wait, 2000);
+            } else {
+                // Show success message
+                showMessage("Attendance", "Recorded!");
+                buzzerSuccessBeep();  // Keeps playing while the next ID is typed
+                CO_SLEEP(co, flow.wait, 500);
+            }
+
+            // Ready for the next student right away
+            flow.idIndex = 0;
+            memset(flow.id, 0, sizeof(flow.id));
+            inputDeadline = Clock_Deadline(ATTENDANCE_TIME_LIMIT * 1000UL);
+            submitStudentDrawPrompt();
         }
+        CO_END(co);
     }
 
     // ----------------- Main -----------------
@@ -1183,26 +1004,48 @@ void monitorTraffic(void) {
         displayMenu();
         
         uint8_t displayUpdateNeeded = 0;
-        uint8_t lastKey = 0;
+        char lastKey = 0;
 
         while (1) {
-            char key = getKeypadInput();
-            
-            if (key && key != lastKey) {
-                lastKey = key;
-                handleKeypad();
+            Timer_Service();
+            Command_Poll();
+
+            char key = 0;
+            if (keypadActivity()) {
+                Clock_SetTickMs(1);  // Full resolution while someone is typing
+                key = getKeypadInput();
+            }
+
+            // Report each press once, not every pass while it is held
+            char pressed = (key != lastKey) ? key : 0;
+            lastKey = key;
+
+            if (!activeFlow && pressed) {
+                handleKeypad(pressed);
                 displayUpdateNeeded = 1;
+                pressed = 0;
             }
-            
-            if (!key) {
-                lastKey = 0;
+
+            if (activeFlow) {
+                flow.key = pressed;
+                if (activeFlow() == CO_DONE) {
+                    activeFlow = NULL;
+                    displayUpdateNeeded = 1;
+                }
             }
 
-            if (displayUpdateNeeded || previousMenu != currentMenu) {
+            if (!activeFlow && (displayUpdateNeeded || previousMenu != currentMenu)) {
                 displayMenu();
                 displayUpdateNeeded = 0;
-            }        
-            GLCD_Render();
+            }
+
+            // Nothing held down and the screen is current: sleep
+            if (!key) {
+                // Deferred EEPROM copies and tombstone compaction; records
+                // only move while nobody is walking the list
+                Store_Service(!activeFlow && !Command_IsBusy());
+                idleUntilEvent();
+            }
         }
         
         return 0;
@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Clock.h"
+#include "Command.h"
+#include "EEQueue.h"
+#include "EESim.h"
+#include "Frame.h"
+#include "HostStubs.h"
+#include "Roster.h"
+#include "Session.h"
+#include "Store.h"
+
+// Command.h over the stub USART: text replies, with the TX ring full
+// now and then so they yield; LIST while check-ins land between its
+// lines; EXPORT and SYNC frames parsed and CRC-checked, then ACK;
+// IMPORT of a good, a damaged and a cut roster frame; the archive
+// commands after CLOSE
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+#define COMMANDTEST_PASSES      1000000   // Polls a reply may take
+#define COMMANDTEST_ROOM        30      // TX ring room per pass when tight
+
+static char CommandTest_Text[HOSTSTUBS_TX_SIZE + 1];
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void CommandTest_Send(const char *Line, const uint16_t Room);
+static const char *CommandTest_Finish(const uint16_t Room);
+static const char *CommandTest_Run(const char *Line);
+static const uint8_t *CommandTest_Frame(const uint8_t Type, const uint8_t Version, uint16_t *Count);
+static void CommandTest_Import(const uint16_t Count, const uint8_t Damage, const uint16_t Cut);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    static const char *ids[] = { "23101001", "23101002", "23101003" };
+    const uint8_t *record;
+    char expect[128];
+    uint32_t packed, time;
+    uint16_t count, upto;
+    uint8_t session;
+
+    EESim_Reset();
+    Store_Load();
+    Roster_Load();
+
+    CHECK(strcmp(CommandTest_Run("BOGUS"), "ERR UNKNOWN\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("LIST 1 2 3 4 5 6 7 8 9 10 11 12 13 14"), "ERR TOO LONG\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("time 08:00"), "OK\r\n") == 0);
+    CHECK(Clock_Seconds() == 8 * 3600UL);
+    CHECK(strcmp(CommandTest_Run("TIME"), "OK 08:00:00\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("TIME 24:00"), "ERR BAD TIME\r\n") == 0);
+
+    // The host takes the empty list first, so later syncs are deltas
+    CommandTest_Run("SYNC FULL");
+    record = CommandTest_Frame(FRAME_TYPE_SYNC, SYNC_SCHEMA_VERSION, &count);
+    CHECK(count == 1 && record[0] == SYNC_KIND_SNAPSHOT);
+    memcpy(&upto, &record[1], sizeof(upto));
+    snprintf(expect, sizeof(expect), "ACK %u", upto);
+    CHECK(strcmp(CommandTest_Run(expect), "OK\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("ACK 70000"), "ERR BAD SEQ\r\n") == 0);
+
+    // Checked in out of order, listed by time
+    CHECK(Store_Add(ids[0], 8 * 3600UL + 60) == STORE_OK);
+    CHECK(Store_Add(ids[2], 8 * 3600UL + 180) == STORE_OK);
+    CHECK(Store_Add(ids[1], 8 * 3600UL + 120) == STORE_OK);
+    CHECK(strcmp(CommandTest_Run("COUNT"), "OK 3\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("FIND 23101002"), "OK 23101002 08:02:00\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("FIND 23101009"), "ERR NOT FOUND\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("LIST"),
+            "OK 3\r\n23101001 08:01:00\r\n23101002 08:02:00\r\n23101003 08:03:00\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("RANGE 08:02 08:03"), "OK 1\r\n23101002 08:02:00\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("RANGE 8:99"), "ERR BAD TIME\r\n") == 0);
+
+    // A check-in before the cursor (same minute, lower ID) while LIST
+    // waits for the TX ring neither repeats nor skips a line
+    CommandTest_Send("LIST", COMMANDTEST_ROOM);
+    CHECK(Command_IsBusy());
+    CHECK(Store_Add("23100999", 8 * 3600UL + 60) == STORE_OK);
+    CHECK(strcmp(CommandTest_Finish(COMMANDTEST_ROOM),
+            "OK 3\r\n23101001 08:01:00\r\n23101002 08:02:00\r\n23101003 08:03:00\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("DEL 23100999"), "OK\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("DEL 23100999"), "ERR NOT FOUND\r\n") == 0);
+
+    // Attendance frame: packed ID and timestamp per record, by time
+    CommandTest_Send("EXPORT 08:02", 0);
+    CommandTest_Finish(COMMANDTEST_ROOM);
+    record = CommandTest_Frame(FRAME_TYPE_ATTENDANCE, EXPORT_SCHEMA_VERSION, &count);
+    CHECK(count == 2);
+    for (uint8_t i = 0; i < count; i++, record += EXPORT_RECORD_SIZE) {
+        packed = 0;
+        memcpy(&packed, record, PACKED_ID_SIZE);
+        memcpy(&time, &record[PACKED_ID_SIZE], sizeof(time));
+        CHECK(packed == packStudentID(ids[1 + i]) && time == 8 * 3600UL + 120 + 60 * i);
+    }
+
+    // Delta since the ACK: the three check-ins, and the removal of the
+    // one that came and went
+    CommandTest_Run("SYNC");
+    record = CommandTest_Frame(FRAME_TYPE_SYNC, SYNC_SCHEMA_VERSION, &count);
+    CHECK(count == 5 && record[0] == SYNC_KIND_DELTA);
+    memcpy(&upto, &record[1], sizeof(upto));
+    for (uint8_t i = 1, added = 0; i < count; i++) {
+        record += SYNC_RECORD_SIZE;
+        packed = 0;
+        memcpy(&packed, &record[3], PACKED_ID_SIZE);
+        if (record[0] == SYNC_KIND_REMOVED) {
+            CHECK(packed == packStudentID("23100999"));
+        } else {
+            CHECK(record[0] == SYNC_KIND_ADDED);
+            CHECK(packed == packStudentID(ids[0]) || packed == packStudentID(ids[1]) || packed == packStudentID(ids[2]));
+            CHECK(++added <= 3);
+        }
+    }
+    snprintf(expect, sizeof(expect), "ACK %u", upto);
+    CHECK(strcmp(CommandTest_Run(expect), "OK\r\n") == 0);
+    CHECK(Store_SyncCursor() == upto);
+    CommandTest_Run("SYNC");
+    CommandTest_Frame(FRAME_TYPE_SYNC, SYNC_SCHEMA_VERSION, &count);
+    CHECK(count == 1);
+    CHECK(strcmp(CommandTest_Run("SYNC HALF"), "ERR UNKNOWN\r\n") == 0);
+
+    // Roster 23101001..23101005: the first three are present
+    CommandTest_Import(5, 0, 0);
+    CHECK(strcmp(CommandTest_Text, "OK READY\r\nOK 5 0\r\n") == 0);
+    CHECK(strcmp(CommandTest_Run("ABSENT"), "OK 2\r\n23101004\r\n23101005\r\n") == 0);
+    CommandTest_Import(8, 1, 0);
+    CHECK(strcmp(CommandTest_Text, "OK READY\r\nERR CRC\r\n") == 0);
+    CommandTest_Import(8, 0, 4);
+    CHECK(strcmp(CommandTest_Text, "OK READY\r\nERR TIMEOUT\r\n") == 0);
+    CHECK(Roster_Count() == 5);
+    // The line parser is fine after both
+    CHECK(strcmp(CommandTest_Run("COUNT"), "OK 3\r\n") == 0);
+
+    // Archive
+    CommandTest_Run("CLOSE");
+    snprintf(expect, sizeof(expect), "OK %u\r\n", Store_Session());
+    CHECK(strcmp(CommandTest_Text, expect) == 0);
+    session = Session_Get(0)->Id;
+    CHECK(Store_Count() == 0 && Session_Count() == 1);
+    CHECK(strcmp(CommandTest_Run("CLOSE"), "ERR EMPTY\r\n") == 0);
+    snprintf(expect, sizeof(expect), "OK 1\r\n%u %02u:%02u 3\r\n", session,
+            (uint8_t)((Session_Get(0)->Start / 3600) % 24), (uint8_t)((Session_Get(0)->Start / 60) % 60));
+    CHECK(strcmp(CommandTest_Run("SESSIONS"), expect) == 0);
+    snprintf(expect, sizeof(expect), "SESSION %u", session);
+    CHECK(strcmp(CommandTest_Run(expect),
+            "OK 3\r\n23101001 08:01:00\r\n23101002 08:02:00\r\n23101003 08:03:00\r\n") == 0);
+    snprintf(expect, sizeof(expect), "SESSION %u", (uint8_t)(session + 1));
+    CHECK(strcmp(CommandTest_Run(expect), "ERR NOT FOUND\r\n") == 0);
+    snprintf(expect, sizeof(expect), "EXPORT SESSION %u", session);
+    CommandTest_Send(expect, COMMANDTEST_ROOM);
+    CommandTest_Finish(COMMANDTEST_ROOM);
+    record = CommandTest_Frame(FRAME_TYPE_ATTENDANCE, EXPORT_SCHEMA_VERSION, &count);
+    CHECK(count == 3);
+    for (uint8_t i = 0; i < count; i++, record += EXPORT_RECORD_SIZE) {
+        packed = 0;
+        memcpy(&packed, record, PACKED_ID_SIZE);
+        CHECK(packed == packStudentID(ids[i]));
+    }
+
+    EEQueue_Flush();
+    CHECK(EESim_Stats.Misuse == 0);
+    printf("CommandTest: ok\n");
+    return 0;
+}
+
+// Line in, first pass with Room free in the TX ring
+static void CommandTest_Send(const char *Line, const uint16_t Room)
+{
+    CHECK(!Command_IsBusy());
+    HostStubs_TxClear();
+    HostStubs_TxRoom = Room;
+    HostStubs_Receive(Line, strlen(Line));
+    HostStubs_Receive("\r", 1);
+    Command_Poll();
+}
+
+// Polls until the reply is out, the ring drained to Room free before
+// each pass; what was sent, as text. The clock moves a millisecond a
+// pass, but only while no EEPROM write is pending: the simulated writes
+// are far quicker than 8.5 ms, so they must not look like a quiet host.
+static const char *CommandTest_Finish(const uint16_t Room)
+{
+    for (uint32_t n = 0; Command_IsBusy(); n++) {
+        CHECK(n < COMMANDTEST_PASSES);
+        HostStubs_TxRoom = Room;
+        if (EEQueue_IsIdle()) HostStubs_Millis++;
+        Command_Poll();
+    }
+    memcpy(CommandTest_Text, HostStubs_Tx, HostStubs_TxLength);
+    CommandTest_Text[HostStubs_TxLength] = '\0';
+    return CommandTest_Text;
+}
+
+// Every other command with the TX ring tight, so replies yield
+static const char *CommandTest_Run(const char *Line)
+{
+    static uint8_t tight = 0;
+
+    tight ^= 1;
+    CommandTest_Send(Line, tight ? COMMANDTEST_ROOM : 0xFF);
+    return CommandTest_Finish(tight ? COMMANDTEST_ROOM : 0xFF);
+}
+
+// The one frame sent: header checked, CRC good; its records
+static const uint8_t *CommandTest_Frame(const uint8_t Type, const uint8_t Version, uint16_t *Count)
+{
+    const uint8_t *frame = HostStubs_Tx;
+    uint16_t length = HostStubs_TxLength, crc;
+    uint8_t size = Type == FRAME_TYPE_SYNC ? SYNC_RECORD_SIZE : EXPORT_RECORD_SIZE;
+
+    CHECK(length >= FRAME_HEADER_SIZE + 2);
+    CHECK(frame[0] == FRAME_SOF0 && frame[1] == FRAME_SOF1 && frame[2] == Type && frame[3] == Version);
+    *Count = frame[4] | frame[5] << 8;
+    CHECK(length == FRAME_HEADER_SIZE + *Count * size + 2);
+    crc = Frame_Crc16(FRAME_CRC_INIT, &frame[2], length - 4);
+    CHECK(frame[length - 2] == (crc & 0xFF) && frame[length - 1] == crc >> 8);
+    return &frame[FRAME_HEADER_SIZE];
+}
+
+// IMPORT, then a roster frame of 23101001 on: Damage 1 flips a CRC
+// bit; Cut drops that many bytes from the end, for the timeout
+static void CommandTest_Import(const uint16_t Count, const uint8_t Damage, const uint16_t Cut)
+{
+    uint8_t frame[FRAME_HEADER_SIZE + 16 * PACKED_ID_SIZE + 2];
+    uint16_t length = 0, crc;
+
+    CHECK(Count <= 16);
+    frame[length++] = FRAME_SOF0;
+    frame[length++] = FRAME_SOF1;
+    frame[length++] = FRAME_TYPE_ROSTER;
+    frame[length++] = ROSTER_SCHEMA_VERSION;
+    frame[length++] = Count & 0xFF;
+    frame[length++] = Count >> 8;
+    for (uint16_t i = 0; i < Count; i++) {
+        uint32_t packed = packStudentID("23101001") + i;
+
+        memcpy(&frame[length], &packed, PACKED_ID_SIZE);
+        length += PACKED_ID_SIZE;
+    }
+    crc = Frame_Crc16(FRAME_CRC_INIT, &frame[2], length - 2) ^ (Damage == 1);
+    frame[length++] = crc & 0xFF;
+    frame[length++] = crc >> 8;
+
+    CommandTest_Send("IMPORT", 0xFF);
+    HostStubs_Receive(frame, length - Cut);
+    CommandTest_Finish(0xFF);
+}
+//---------------------------//
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EEQueue.h"
+#include "EESim.h"
+
+// EEQueue.h against the simulated EEPROM: reads see queued bytes, the
+// newest write of a cell wins, unchanged cells are not programmed, and
+// a read that misses the queue waits for the running write only
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+static uint8_t EEQueueTest_Reference[EESIM_SIZE];
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void EEQueueTest_Compare(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    uint8_t buffer[64];
+    uint32_t writes;
+
+    EESim_Reset();
+    memset(EEQueueTest_Reference, 0xFF, sizeof(EEQueueTest_Reference));
+    srand(3);
+
+    // Random traffic, checked before and after it reaches the EEPROM
+    for (uint16_t n = 0; n < 3000; n++) {
+        uint16_t addr = rand() % EESIM_SIZE;
+        uint8_t length = 1 + rand() % sizeof(buffer);
+
+        if (addr + length > EESIM_SIZE) length = EESIM_SIZE - addr;
+        if (rand() % 2) {
+            for (uint8_t i = 0; i < length; i++) buffer[i] = rand();
+            EEQueue_WriteBlock(buffer, addr, length);
+            memcpy(&EEQueueTest_Reference[addr], buffer, length);
+        } else {
+            EEQueue_ReadBlock(buffer, addr, length);
+            CHECK(memcmp(buffer, &EEQueueTest_Reference[addr], length) == 0);
+        }
+        if (n % 100 == 0) EEQueueTest_Compare();
+    }
+    EEQueueTest_Compare();
+
+    // The newest queued value of a cell is the one read and kept
+    EEQueue_WriteByte(10, 0x11);
+    EEQueue_WriteWord(10, 0x3322);
+    CHECK(EEQueue_ReadByte(10) == 0x22);
+    CHECK(EEQueue_ReadWord(10) == 0x3322);
+    EEQueue_Flush();
+    CHECK(EESim_Memory[10] == 0x22 && EESim_Memory[11] == 0x33);
+
+    // A cell that already holds the value is skipped
+    writes = EESim_Stats.Writes;
+    EEQueue_WriteBlock(&EESim_Memory[100], 100, 20);
+    EEQueue_Flush();
+    CHECK(EESim_Stats.Writes == writes);
+
+    // A read outside a burst holds the queue for the running write only,
+    // then the burst carries on. Masked meanwhile, as the ISR would
+    // otherwise drain the burst before the check.
+    memset(buffer, 0x5A, sizeof(buffer));
+    EEQueue_WriteBlock(buffer, 200, 30);
+    EESim_Masked++;
+    writes = EESim_Stats.Writes;
+    CHECK(EEQueue_ReadByte(900) == EESim_Memory[900]);
+    CHECK(EESim_Stats.Writes - writes <= 1);
+    CHECK(!EEQueue_IsIdle());
+    EESim_Masked--;
+    EEQueue_Flush();
+    CHECK(memcmp(&EESim_Memory[200], buffer, 30) == 0);
+    CHECK(EEQueue_Room() == EEQUEUE_SIZE - 1);
+
+    CHECK(EESim_Stats.Misuse == 0);
+    printf("EEQueueTest: ok\n");
+    return 0;
+}
+
+// Everything queued is in the EEPROM once the queue drains
+static void EEQueueTest_Compare(void)
+{
+    EEQueue_Flush();
+    CHECK(EEQueue_IsIdle());
+    CHECK(memcmp(EESim_Memory, EEQueueTest_Reference, EESIM_SIZE) == 0);
+}
+//---------------------------//
@@ -0,0 +1,148 @@
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "EESim.h"
+
+//----- Auxiliary data ------//
+uint8_t EESim_Memory[EESIM_SIZE];
+EESimStats_t EESim_Stats;
+int32_t EESim_WritesLeft = -1;
+volatile uint8_t EESim_Masked = 0;
+
+static volatile uint8_t EESim_Cr, EESim_Dr;
+static volatile uint16_t EESim_Ar;
+static uint16_t EESim_WriteAddr;
+static uint8_t EESim_WriteData;
+static uint8_t EESim_Busy;                  // Accesses left in the write cycle
+static uint8_t EESim_Cut;                   // Power is off: writes are lost
+static uint8_t EESim_Torn;                  // How the next cut leaves its cell
+static volatile uint8_t EESim_Inside;       // In EESim_Update() or the ISR
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void EESim_Update(void);
+static void EESim_Program(void);
+static void EESim_Tick(int Signal);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Erased EEPROM, no power cut, counters cleared. Also starts the timer
+// that stands in for time passing while the code spins on RAM only.
+void EESim_Reset(void)
+{
+    static uint8_t started = 0;
+
+    memset(EESim_Memory, 0xFF, sizeof(EESim_Memory));
+    memset(&EESim_Stats, 0, sizeof(EESim_Stats));
+    EESim_PowerOn();
+    if (!started) {
+        struct itimerval every = { { 0, EESIM_TICK_US }, { 0, EESIM_TICK_US } };
+
+        signal(SIGALRM, EESim_Tick);
+        setitimer(ITIMER_REAL, &every, NULL);
+        started = 1;
+    }
+}
+
+// Registers cleared and nothing running, as after a reset
+void EESim_PowerOn(void)
+{
+    EESim_Cr = EESim_Dr = 0;
+    EESim_Ar = 0;
+    EESim_Busy = 0;
+    EESim_Cut = 0;
+    EESim_Masked = 0;
+    EESim_WritesLeft = -1;
+}
+
+// The power cut has happened: the EEPROM takes no more writes
+uint8_t EESim_IsCut(void)
+{
+    return EESim_Cut;
+}
+
+volatile uint8_t *EESim_Eecr(void)
+{
+    EESim_Update();
+    return &EESim_Cr;
+}
+
+volatile uint8_t *EESim_Eedr(void)
+{
+    EESim_Update();
+    return &EESim_Dr;
+}
+
+volatile uint16_t *EESim_Eear(void)
+{
+    EESim_Update();
+    if (EESim_Busy) EESim_Stats.Misuse++;
+    return &EESim_Ar;
+}
+
+// One register access: the write cycle advances, a pending read
+// completes, and the interrupt fires if it is due
+static void EESim_Update(void)
+{
+    uint8_t inside = EESim_Inside;
+
+    EESim_Inside = 1;
+    EESim_Stats.Accesses++;
+    if (EESim_Busy) {
+        if (--EESim_Busy == 0) {
+            EESim_Program();
+            EESim_Cr &= ~(1 << EESIM_EEWE);
+        }
+    } else if (EESim_Cr & (1 << EESIM_EEWE)) {
+        // Just set: EEAR and EEDR are latched now
+        if (!(EESim_Cr & (1 << EESIM_EEMWE))) EESim_Stats.Misuse++;
+        EESim_Cr &= ~(1 << EESIM_EEMWE);
+        EESim_WriteAddr = EESim_Ar;
+        EESim_WriteData = EESim_Dr;
+        EESim_Busy = EESIM_WRITE_POLLS;
+    }
+
+    if (EESim_Cr & (1 << EESIM_EERE)) {
+        if (EESim_Busy) {
+            EESim_Stats.Misuse++;
+        } else {
+            EESim_Dr = EESim_Memory[EESim_Ar % EESIM_SIZE];
+            EESim_Cr &= ~(1 << EESIM_EERE);
+        }
+    }
+
+    if (!inside && !EESim_Masked && (EESim_Cr & (1 << EESIM_EERIE)) && !(EESim_Cr & (1 << EESIM_EEWE))) {
+        EESim_Stats.Interrupts++;
+        EE_RDY_vect();
+    }
+    EESim_Inside = inside;
+}
+
+static void EESim_Program(void)
+{
+    uint8_t *cell = &EESim_Memory[EESim_WriteAddr % EESIM_SIZE];
+
+    if (EESim_Cut) return;
+    if (EESim_WritesLeft == 0) {
+        // Torn: old value, erased, or the new one, in turn
+        if (EESim_Torn == 1) *cell = 0xFF;
+        else if (EESim_Torn == 2) *cell = EESim_WriteData;
+        EESim_Torn = (EESim_Torn + 1) % 3;
+        EESim_Cut = 1;
+        return;
+    }
+    if (EESim_WritesLeft > 0) EESim_WritesLeft--;
+    *cell = EESim_WriteData;
+    EESim_Stats.Writes++;
+}
+
+// Timer signal: a write cycle passes even while the code spins on
+// RAM, e.g. for room in a full write queue. Like the AVR interrupt,
+// it cannot break into a masked section or into the model itself.
+static void EESim_Tick(int Signal)
+{
+    (void)Signal;
+    for (uint8_t n = 0; n < EESIM_WRITE_POLLS && !EESim_Inside && !EESim_Masked; n++) EESim_Update();
+}
+//---------------------------//
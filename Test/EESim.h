@@ -0,0 +1,71 @@
+#ifndef EESIM_H_INCLUDED
+#define EESIM_H_INCLUDED
+/*
+||
+||  Filename:           EESim.h
+||  Title:              Simulated internal EEPROM for host tests
+||  Compiler:           GCC (host)
+||  Description:
+||  Stands in for the ATmega32 EEPROM behind EEQueue.h. The
+||  host avr/io.h maps EEAR, EEDR and EECR here, so the queue
+||  and its EE_RDY interrupt run unchanged: every register
+||  access advances the model, which starts a write when EEWE
+||  is set, finishes it EESIM_WRITE_POLLS accesses later, and
+||  calls EE_RDY_vect while EERIE is set, no write is running
+||  and interrupts are on (see the host util/atomic.h). A
+||  timer signal (SIGALRM) advances it too, so code spinning
+||  on RAM alone, as on a full queue, still sees time pass.
+||
+||  Misuse a real chip would punish is counted: EEWE without
+||  EEMWE, a read or an address change while a write runs.
+||
+||  Power cuts: with WritesLeft at 0 the next write is torn
+||  (the cell keeps its old value, is left erased or takes
+||  the new one) and every later one is lost, until PowerOn().
+||  The code under test keeps running meanwhile; the test then
+||  drops its RAM state by loading again, as a reset would.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define EESIM_SIZE              1024    // ATmega32, E2END + 1
+#define EESIM_WRITE_POLLS       4       // Register accesses per write cycle
+#define EESIM_TICK_US           50      // Timer signal period, see EESim_Reset()
+
+#define EESIM_EERE              0
+#define EESIM_EEWE              1
+#define EESIM_EEMWE             2
+#define EESIM_EERIE             3
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint32_t Writes;            // Bytes programmed
+    uint32_t Misuse;            // See above; must stay 0
+    uint32_t Interrupts;        // EE_RDY_vect calls
+    uint32_t Accesses;          // Register accesses, a measure of time
+} EESimStats_t;
+//-------------------------------------------------//
+
+//----- Data --------------------------------------//
+extern uint8_t EESim_Memory[EESIM_SIZE];
+extern EESimStats_t EESim_Stats;
+extern int32_t EESim_WritesLeft;        // -1 = no power cut
+extern volatile uint8_t EESim_Masked;   // ATOMIC_BLOCK nesting
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void EESim_Reset(void);
+void EESim_PowerOn(void);
+uint8_t EESim_IsCut(void);
+volatile uint8_t *EESim_Eecr(void);
+volatile uint8_t *EESim_Eedr(void);
+volatile uint16_t *EESim_Eear(void);
+void EE_RDY_vect(void);
+//-----------------------------------------------------------------------------//
+#endif
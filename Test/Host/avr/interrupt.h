@@ -0,0 +1,10 @@
+#ifndef HOST_AVR_INTERRUPT_H_INCLUDED
+#define HOST_AVR_INTERRUPT_H_INCLUDED
+// Host stand-in: a vector is a plain function the simulation calls
+
+//----- Headers ------------//
+#include "EESim.h"
+//--------------------------//
+
+#define ISR(Vector)             void Vector(void)
+#endif
@@ -0,0 +1,28 @@
+#ifndef HOST_AVR_IO_H_INCLUDED
+#define HOST_AVR_IO_H_INCLUDED
+// Host stand-in: port D is the simulated I2C bus (see I2CSim.h), the
+// EEPROM registers the simulated internal EEPROM (see EESim.h)
+
+//----- Headers ------------//
+#include <stdint.h>
+
+#include "EESim.h"
+#include "I2CSim.h"
+//--------------------------//
+
+#define DDRD                    (*I2CSim_Ddr())
+#define PIND                    (I2CSim_Pin())
+#define PORTD                   I2CSim_Port
+#define PD2                     2
+#define PD3                     3
+
+#define EEAR                    (*EESim_Eear())
+#define EEDR                    (*EESim_Eedr())
+#define EECR                    (*EESim_Eecr())
+#define EERE                    EESIM_EERE
+#define EEWE                    EESIM_EEWE
+#define EEMWE                   EESIM_EEMWE
+#define EERIE                   EESIM_EERIE
+
+#define E2END                   (EESIM_SIZE - 1)
+#endif
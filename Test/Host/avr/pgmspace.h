@@ -0,0 +1,12 @@
+#ifndef HOST_AVR_PGMSPACE_H_INCLUDED
+#define HOST_AVR_PGMSPACE_H_INCLUDED
+// Host stand-in: flash and RAM are the same address space
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+#define PROGMEM
+#define pgm_read_byte(Addr)     (*(const uint8_t *)(Addr))
+#define pgm_read_word(Addr)     (*(const uint16_t *)(Addr))
+#endif
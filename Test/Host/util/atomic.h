@@ -0,0 +1,21 @@
+#ifndef HOST_UTIL_ATOMIC_H_INCLUDED
+#define HOST_UTIL_ATOMIC_H_INCLUDED
+// Host stand-in: masks the simulated EEPROM interrupt (see EESim.h),
+// left again however the block is left, return included
+
+//----- Headers ------------//
+#include <stdint.h>
+
+#include "EESim.h"
+//--------------------------//
+
+static inline void HostAtomic_Leave(uint8_t *Once)
+{
+    (void)Once;
+    EESim_Masked--;
+}
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(Type)      for (uint8_t HostAtomic_Once __attribute__((cleanup(HostAtomic_Leave))) = (EESim_Masked++, 1); \
+                                        HostAtomic_Once; HostAtomic_Once = 0)
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOST_UTIL_CRC16_H_INCLUDED
+#define HOST_UTIL_CRC16_H_INCLUDED
+// Host stand-in: the avr-libc CRC-8, polynomial 0x07
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+static inline uint8_t _crc8_ccitt_update(uint8_t Crc, uint8_t Data)
+{
+    Crc ^= Data;
+    for (uint8_t i = 0; i < 8; i++) {
+        Crc = (Crc & 0x80) ? (Crc << 1) ^ 0x07 : Crc << 1;
+    }
+    return Crc;
+}
+#endif
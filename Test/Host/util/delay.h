@@ -0,0 +1,20 @@
+#ifndef HOST_UTIL_DELAY_H_INCLUDED
+#define HOST_UTIL_DELAY_H_INCLUDED
+// Host stand-in: a delay lets the simulated chip look at the bus
+
+//----- Headers ------------//
+#include "I2CSim.h"
+//--------------------------//
+
+static inline void _delay_us(double Us)
+{
+    (void)Us;
+    I2CSim_Update();
+}
+
+static inline void _delay_ms(double Ms)
+{
+    (void)Ms;
+    I2CSim_Update();
+}
+#endif
@@ -0,0 +1,99 @@
+#include <string.h>
+
+#include "Clock.h"
+#include "HostStubs.h"
+#include "USART.h"
+
+// Just enough of the target for the store, archive and command code
+// to link on the host (see HostStubs.h). EEPROM access goes through
+// the real EEQueue on the simulated EEPROM (see EESim.h).
+
+//----- Auxiliary data ------//
+uint8_t HostStubs_Tx[HOSTSTUBS_TX_SIZE];
+uint16_t HostStubs_TxLength = 0;
+uint16_t HostStubs_TxRoom = 0xFF;
+uint32_t HostStubs_Millis = 0;
+
+static uint8_t HostStubs_Rx[HOSTSTUBS_RX_SIZE];
+static uint16_t HostStubs_RxHead = 0, HostStubs_RxTail = 0;
+static uint32_t HostStubs_Seconds = 0;
+//---------------------------//
+
+//----- Functions -------------//
+void HostStubs_Receive(const void *Data, const uint16_t Length)
+{
+    const uint8_t *data = Data;
+
+    for (uint16_t i = 0; i < Length; i++) {
+        HostStubs_Rx[HostStubs_RxHead] = data[i];
+        HostStubs_RxHead = (HostStubs_RxHead + 1) % HOSTSTUBS_RX_SIZE;
+    }
+}
+
+// Forget what was sent and empty the TX ring
+void HostStubs_TxClear(void)
+{
+    HostStubs_TxLength = 0;
+    HostStubs_TxRoom = 0xFF;
+}
+
+uint8_t USART_TryWrite(const uint8_t *Data, const uint8_t Length)
+{
+    if (Length > HostStubs_TxRoom || HostStubs_TxLength + Length > HOSTSTUBS_TX_SIZE) return 0;
+    memcpy(&HostStubs_Tx[HostStubs_TxLength], Data, Length);
+    HostStubs_TxLength += Length;
+    HostStubs_TxRoom -= Length;
+    return 1;
+}
+
+uint8_t USART_TryTransmitString(const char *Str)
+{
+    uint16_t length = strlen(Str);
+
+    // All of the line or nothing, as on the target
+    if (length + 2 > HostStubs_TxRoom || HostStubs_TxLength + length + 2 > HOSTSTUBS_TX_SIZE) return 0;
+    USART_TryWrite((const uint8_t *)Str, length);
+    return USART_TryWrite((const uint8_t *)"\r\n", 2);
+}
+
+uint8_t USART_TxFree(void)
+{
+    return HostStubs_TxRoom > 0xFF ? 0xFF : HostStubs_TxRoom;
+}
+
+int16_t USART_Read(void)
+{
+    uint8_t c;
+
+    if (HostStubs_RxHead == HostStubs_RxTail) return -1;
+    c = HostStubs_Rx[HostStubs_RxTail];
+    HostStubs_RxTail = (HostStubs_RxTail + 1) % HOSTSTUBS_RX_SIZE;
+    return c;
+}
+
+void USART_SetFlowControl(const uint8_t Enable)
+{
+    (void)Enable;
+}
+
+uint32_t Clock_Millis(void)
+{
+    return HostStubs_Millis;
+}
+
+uint32_t Clock_Seconds(void)
+{
+    return HostStubs_Seconds;
+}
+
+void Clock_SetSeconds(const uint32_t Seconds)
+{
+    HostStubs_Seconds = Seconds;
+}
+
+uint32_t Clock_TimeToday(const uint8_t Hours, const uint8_t Minutes, const uint8_t Seconds)
+{
+    return HostStubs_Seconds / CLOCK_SECONDS_PER_DAY * CLOCK_SECONDS_PER_DAY
+            + Hours * 3600UL + Minutes * 60UL + Seconds;
+}
+//---------------------------//
@@ -0,0 +1,38 @@
+#ifndef HOSTSTUBS_H_INCLUDED
+#define HOSTSTUBS_H_INCLUDED
+/*
+||
+||  Filename:           HostStubs.h
+||  Title:              USART and clock stand-ins for host tests
+||  Compiler:           GCC (host)
+||  Description:
+||  Just enough of the target for the store, archive and
+||  command code to link on the host. Bytes queued for the
+||  USART are appended to HostStubs_Tx, up to TxRoom bytes at
+||  a time (a test drains the ring by resetting TxRoom);
+||  Receive() puts bytes in the RX ring. The clock only moves
+||  when a test sets it.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define HOSTSTUBS_TX_SIZE       4096
+#define HOSTSTUBS_RX_SIZE       1024
+//-------------------------------------------------//
+
+//----- Data --------------------------------------//
+extern uint8_t HostStubs_Tx[HOSTSTUBS_TX_SIZE];
+extern uint16_t HostStubs_TxLength;
+extern uint16_t HostStubs_TxRoom;       // Free bytes in the TX ring
+extern uint32_t HostStubs_Millis;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void HostStubs_Receive(const void *Data, const uint16_t Length);
+void HostStubs_TxClear(void);
+//-----------------------------------------------------------------------------//
+#endif
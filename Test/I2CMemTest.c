@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "I2CMem.h"
+#include "I2CSim.h"
+
+// I2CMem.h against the simulated chip: contents, one write cycle per
+// page touched, and the missing-chip and stuck-bus cases
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+static uint8_t I2CMemTest_Reference[I2CSIM_SIZE];
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void I2CMemTest_Write(const uint16_t Addr, const uint16_t Length);
+static void I2CMemTest_Read(const uint16_t Addr, const uint16_t Length);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    uint8_t buffer[64];
+
+    I2CSim_Reset();
+    I2CMem_Init();
+    memset(I2CMemTest_Reference, 0xFF, sizeof(I2CMemTest_Reference));
+    srand(5);
+
+    // Page boundaries, the last page, and random traffic
+    I2CMemTest_Write(60, 8);
+    I2CMemTest_Write(I2CMEM_SIZE - 3, 3);
+    I2CMemTest_Read(I2CMEM_SIZE - 10, 10);
+    for (uint16_t n = 0; n < 2000; n++) {
+        uint16_t addr = rand() % I2CMEM_SIZE;
+        uint16_t length = 1 + rand() % 200;
+
+        if (addr + length > I2CMEM_SIZE) length = I2CMEM_SIZE - addr;
+        if (rand() % 2) I2CMemTest_Write(addr, length);
+        else I2CMemTest_Read(addr, length);
+    }
+    CHECK(!memcmp(I2CSim_Memory, I2CMemTest_Reference, sizeof(I2CSim_Memory)));
+    CHECK(I2CSim_Stats.Overruns == 0);
+    CHECK(I2CSim_Stats.Polls > 0);
+    while (!I2CMem_IsIdle());
+
+    // No chip: erased data, failures, and the driver gives up
+    I2CSim_Present = 0;
+    memset(buffer, 0, sizeof(buffer));
+    CHECK(!I2CMem_Read(buffer, 0, sizeof(buffer)));
+    for (uint8_t i = 0; i < sizeof(buffer); i++) CHECK(buffer[i] == 0xFF);
+    CHECK(!I2CMem_Write(buffer, 0, sizeof(buffer)));
+
+    // SCL held low: bounded wait, then every call returns at once
+    I2CSim_Reset();
+    I2CSim_SclStuck = 1;
+    I2CMem_Init();
+    CHECK(!I2CMem_Read(buffer, 0, sizeof(buffer)));
+    for (uint8_t i = 0; i < sizeof(buffer); i++) CHECK(buffer[i] == 0xFF);
+    CHECK(I2CSim_Stats.Accesses < 4UL * I2CMEM_STRETCH_US);
+    I2CSim_Stats.Accesses = 0;
+    CHECK(!I2CMem_Write(buffer, 0, sizeof(buffer)));
+    CHECK(I2CMem_IsIdle());
+    CHECK(I2CSim_Stats.Accesses == 0);
+
+    // Init after the fault clears talks to the chip again
+    I2CSim_SclStuck = 0;
+    I2CMem_Init();
+    CHECK(I2CMem_Write(buffer, 0, 1));
+
+    printf("I2CMemTest: ok\n");
+    return 0;
+}
+
+// Random bytes; exactly one write cycle per page touched
+static void I2CMemTest_Write(const uint16_t Addr, const uint16_t Length)
+{
+    uint8_t data[256];
+    uint32_t before = I2CSim_Stats.PageWrites;
+
+    for (uint16_t i = 0; i < Length; i++) data[i] = rand();
+    CHECK(I2CMem_Write(data, Addr, Length));
+    memcpy(&I2CMemTest_Reference[Addr], data, Length);
+    CHECK(I2CSim_Stats.PageWrites - before == (Addr + Length - 1UL) / I2CMEM_PAGE_SIZE - Addr / I2CMEM_PAGE_SIZE + 1);
+}
+
+static void I2CMemTest_Read(const uint16_t Addr, const uint16_t Length)
+{
+    uint8_t data[256];
+
+    CHECK(I2CMem_Read(data, Addr, Length));
+    CHECK(!memcmp(data, &I2CMemTest_Reference[Addr], Length));
+}
+//---------------------------//
@@ -0,0 +1,210 @@
+#include <string.h>
+
+#include "I2CSim.h"
+
+//----- Auxiliary data ------//
+uint8_t I2CSim_Memory[I2CSIM_SIZE];
+I2CSimStats_t I2CSim_Stats;
+uint8_t I2CSim_Present = 1;
+uint8_t I2CSim_SclStuck = 0;
+volatile uint8_t I2CSim_Port;
+
+typedef enum
+{
+    I2CSIM_IDLE,                // Waiting for a start
+    I2CSIM_RECEIVE,             // Master sends: device, word address, data
+    I2CSIM_SEND,                // Chip sends a byte
+    I2CSIM_MASTER_ACK           // Master acknowledges the byte sent
+} I2CSimPhase_t;
+
+static uint8_t I2CSim_DdrReg;
+static uint8_t I2CSim_ChipLow;              // Chip pulls SDA low
+static uint8_t I2CSim_LastSda = 1, I2CSim_LastScl = 1;
+static I2CSimPhase_t I2CSim_Phase = I2CSIM_IDLE;
+static uint8_t I2CSim_Bit, I2CSim_Byte;
+static uint8_t I2CSim_AckSlot;              // Acknowledge clock pending
+static uint8_t I2CSim_MasterAck;
+static uint8_t I2CSim_Reading;
+static uint16_t I2CSim_Received;            // Bytes acknowledged this transfer
+static uint16_t I2CSim_Pointer;             // Current address
+static uint16_t I2CSim_Busy;                // Selects left to refuse
+static uint16_t I2CSim_PageStart;
+static uint16_t I2CSim_PageLength;
+static uint8_t I2CSim_PageData[I2CSIM_PAGE_SIZE];
+static uint8_t I2CSim_PageDirty[I2CSIM_PAGE_SIZE];
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static uint8_t I2CSim_Sda(void);
+static uint8_t I2CSim_Scl(void);
+static void I2CSim_Receive(void);
+static void I2CSim_Program(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+// Erased chip, idle bus, no faults, counters cleared
+void I2CSim_Reset(void)
+{
+    memset(I2CSim_Memory, 0xFF, sizeof(I2CSim_Memory));
+    memset(&I2CSim_Stats, 0, sizeof(I2CSim_Stats));
+    memset(I2CSim_PageDirty, 0, sizeof(I2CSim_PageDirty));
+    I2CSim_Present = 1;
+    I2CSim_SclStuck = 0;
+    I2CSim_DdrReg = 0;
+    I2CSim_ChipLow = 0;
+    I2CSim_LastSda = I2CSim_LastScl = 1;
+    I2CSim_Phase = I2CSIM_IDLE;
+    I2CSim_Pointer = 0;
+    I2CSim_Busy = 0;
+}
+
+// Looks at both lines and reacts to what changed since the last look
+void I2CSim_Update(void)
+{
+    uint8_t sda = I2CSim_Sda();
+    uint8_t scl = I2CSim_Scl();
+
+    if (scl && I2CSim_LastScl && I2CSim_LastSda && !sda) {
+        // Start, or repeated start: an unfinished page write is dropped
+        memset(I2CSim_PageDirty, 0, sizeof(I2CSim_PageDirty));
+        I2CSim_Phase = I2CSIM_RECEIVE;
+        I2CSim_Bit = I2CSim_Byte = 0;
+        I2CSim_Received = 0;
+        I2CSim_AckSlot = 0;
+        I2CSim_ChipLow = 0;
+    }
+    else if (scl && I2CSim_LastScl && !I2CSim_LastSda && sda) {
+        // Stop: a page write starts its write cycle
+        if (I2CSim_Phase == I2CSIM_RECEIVE && !I2CSim_Reading && I2CSim_Received > 3) I2CSim_Program();
+        I2CSim_Phase = I2CSIM_IDLE;
+        I2CSim_ChipLow = 0;
+    }
+    else if (!I2CSim_LastScl && scl) {
+        // Data is sampled on the rising edge
+        if (I2CSim_Phase == I2CSIM_RECEIVE && !I2CSim_AckSlot) {
+            I2CSim_Byte = (I2CSim_Byte << 1) | sda;
+            I2CSim_Bit++;
+        }
+        else if (I2CSim_Phase == I2CSIM_MASTER_ACK) {
+            I2CSim_MasterAck = !sda;
+        }
+    }
+    else if (I2CSim_LastScl && !scl) {
+        // The chip changes SDA after the falling edge
+        if (I2CSim_Phase == I2CSIM_RECEIVE) {
+            I2CSim_Receive();
+        }
+        else if (I2CSim_Phase == I2CSIM_SEND) {
+            if (++I2CSim_Bit < 8) {
+                I2CSim_ChipLow = !((I2CSim_Byte << I2CSim_Bit) & 0x80);
+            } else {
+                I2CSim_ChipLow = 0;
+                I2CSim_Phase = I2CSIM_MASTER_ACK;
+            }
+        }
+        else if (I2CSim_Phase == I2CSIM_MASTER_ACK) {
+            I2CSim_Pointer = (I2CSim_Pointer + 1) % I2CSIM_SIZE;
+            if (I2CSim_MasterAck) {
+                I2CSim_Phase = I2CSIM_SEND;
+                I2CSim_Bit = 0;
+                I2CSim_Byte = I2CSim_Memory[I2CSim_Pointer];
+                I2CSim_ChipLow = !(I2CSim_Byte & 0x80);
+            } else {
+                I2CSim_Phase = I2CSIM_IDLE;
+            }
+        }
+    }
+
+    I2CSim_LastSda = I2CSim_Sda();
+    I2CSim_LastScl = I2CSim_Scl();
+}
+
+volatile uint8_t *I2CSim_Ddr(void)
+{
+    I2CSim_Stats.Accesses++;
+    I2CSim_Update();
+    return &I2CSim_DdrReg;
+}
+
+uint8_t I2CSim_Pin(void)
+{
+    I2CSim_Stats.Accesses++;
+    I2CSim_Update();
+    return (I2CSim_Sda() << I2CSIM_SDA) | (I2CSim_Scl() << I2CSIM_SCL);
+}
+
+// Open drain: high unless the master or the chip pulls it low
+static uint8_t I2CSim_Sda(void)
+{
+    return !(I2CSim_DdrReg & (1 << I2CSIM_SDA)) && !I2CSim_ChipLow;
+}
+
+static uint8_t I2CSim_Scl(void)
+{
+    return !(I2CSim_DdrReg & (1 << I2CSIM_SCL)) && !I2CSim_SclStuck;
+}
+
+// Falling edge while the master sends: end of an acknowledge, or of a byte
+static void I2CSim_Receive(void)
+{
+    if (I2CSim_AckSlot) {
+        I2CSim_AckSlot = 0;
+        I2CSim_ChipLow = 0;
+        if (I2CSim_Reading) {
+            I2CSim_Phase = I2CSIM_SEND;
+            I2CSim_Bit = 0;
+            I2CSim_Byte = I2CSim_Memory[I2CSim_Pointer];
+            I2CSim_ChipLow = !(I2CSim_Byte & 0x80);
+        }
+        return;
+    }
+    if (I2CSim_Bit < 8) return;
+
+    if (I2CSim_Received == 0) {
+        if (!I2CSim_Present || (I2CSim_Byte >> 1) != I2CSIM_ADDRESS || I2CSim_Busy) {
+            // Not acknowledged: the transfer is over for this chip
+            if (I2CSim_Present && I2CSim_Busy) {
+                I2CSim_Busy--;
+                I2CSim_Stats.Polls++;
+            }
+            I2CSim_Phase = I2CSIM_IDLE;
+            return;
+        }
+        I2CSim_Reading = I2CSim_Byte & 1;
+    }
+    else if (I2CSim_Received == 1) {
+        I2CSim_Pointer = (uint16_t)I2CSim_Byte << 8;
+    }
+    else if (I2CSim_Received == 2) {
+        I2CSim_Pointer = (I2CSim_Pointer | I2CSim_Byte) % I2CSIM_SIZE;
+        I2CSim_PageStart = I2CSim_Pointer;
+        I2CSim_PageLength = 0;
+    }
+    else {
+        // Page buffer, the offset wraps inside the page
+        uint8_t offset = (I2CSim_PageStart + I2CSim_PageLength) % I2CSIM_PAGE_SIZE;
+
+        I2CSim_PageData[offset] = I2CSim_Byte;
+        I2CSim_PageDirty[offset] = 1;
+        I2CSim_PageLength++;
+    }
+
+    I2CSim_Received++;
+    I2CSim_Bit = I2CSim_Byte = 0;
+    I2CSim_AckSlot = 1;
+    I2CSim_ChipLow = 1;
+}
+
+static void I2CSim_Program(void)
+{
+    uint16_t page = I2CSim_PageStart & ~(I2CSIM_PAGE_SIZE - 1);
+
+    for (uint8_t i = 0; i < I2CSIM_PAGE_SIZE; i++) {
+        if (I2CSim_PageDirty[i]) I2CSim_Memory[page + i] = I2CSim_PageData[i];
+        I2CSim_PageDirty[i] = 0;
+    }
+    if (I2CSim_PageLength > I2CSIM_PAGE_SIZE) I2CSim_Stats.Overruns++;
+    I2CSim_Stats.PageWrites++;
+    I2CSim_Busy = I2CSIM_WRITE_POLLS;
+}
+//---------------------------//
@@ -0,0 +1,64 @@
+#ifndef I2CSIM_H_INCLUDED
+#define I2CSIM_H_INCLUDED
+/*
+||
+||  Filename:           I2CSim.h
+||  Title:              Simulated 24Cxx chip for host tests
+||  Compiler:           GCC (host)
+||  Description:
+||  Stands in for the external memory of I2CMem.h. The host
+||  avr/io.h maps DDRD, PIND and PORTD here, so the driver
+||  runs unchanged: every register access advances the model,
+||  which watches SDA and SCL for start, stop, clock edges and
+||  acknowledge slots like a real chip on the bus.
+||
+||  Modelled after a 24C256: 2-byte word address, 64-byte
+||  pages that wrap inside themselves, a page programmed only
+||  on stop, no acknowledge while a write cycle runs (counted
+||  in device selects instead of milliseconds), and reads that
+||  stream from the current address, wrapping at the end.
+||
+||  Faults: Present = 0 is a missing chip that never answers;
+||  SclStuck = 1 holds SCL low, as missing pull-ups do.
+||
+*/
+
+//----- Headers ------------//
+#include <stdint.h>
+//--------------------------//
+
+//----- Configuration -----------------------------//
+#define I2CSIM_ADDRESS          0x50
+#define I2CSIM_SIZE             32768UL
+#define I2CSIM_PAGE_SIZE        64
+#define I2CSIM_WRITE_POLLS      3       // Device selects refused per write cycle
+
+#define I2CSIM_SDA              2       // PD2
+#define I2CSIM_SCL              3       // PD3
+//-------------------------------------------------//
+
+//----- Types -------------------------------------//
+typedef struct
+{
+    uint32_t PageWrites;        // Write cycles started by a stop
+    uint32_t Polls;             // Device selects refused while busy
+    uint32_t Overruns;          // Page writes longer than a page
+    uint32_t Accesses;          // Register accesses, a measure of time
+} I2CSimStats_t;
+//-------------------------------------------------//
+
+//----- Data --------------------------------------//
+extern uint8_t I2CSim_Memory[I2CSIM_SIZE];
+extern I2CSimStats_t I2CSim_Stats;
+extern uint8_t I2CSim_Present;
+extern uint8_t I2CSim_SclStuck;
+extern volatile uint8_t I2CSim_Port;
+//-------------------------------------------------//
+
+//----- Prototypes ------------------------------------------------------------//
+void I2CSim_Reset(void);
+void I2CSim_Update(void);
+volatile uint8_t *I2CSim_Ddr(void);
+uint8_t I2CSim_Pin(void);
+//-----------------------------------------------------------------------------//
+#endif
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EEQueue.h"
+#include "EESim.h"
+#include "Frame.h"
+#include "Roster.h"
+#include "Store.h"
+
+// Roster.h on the simulated EEPROM: a good import replaces the roster;
+// a bad CRC, a cut transfer, an oversized or unsorted frame, or a power
+// cut anywhere in an import leaves the old one in use; presence follows
+// the store across an import
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+#define ROSTERTEST_STRIDE       7       // Packed IDs Base, Base + 7, ...
+
+static uint8_t RosterTest_Frame[FRAME_HEADER_SIZE + (ROSTER_CAPACITY + 1) * PACKED_ID_SIZE + 2];
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static RosterImport_t RosterTest_Import(const uint32_t Base, const uint16_t Count, const uint8_t Damage, const uint16_t Cut);
+static void RosterTest_Expect(const uint32_t Base, const uint16_t Count);
+static void RosterTest_Boot(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    const uint32_t a = 3100001, b = 3200001, c = 3300001;
+    uint16_t olds = 0, news = 0;
+    char id[STUDENT_ID_LENGTH + 1];
+
+    EESim_Reset();
+    RosterTest_Boot();
+    CHECK(Roster_Count() == 0);
+
+    CHECK(RosterTest_Import(a, 30, 0, 0) == ROSTER_IMPORT_DONE);
+    RosterTest_Expect(a, 30);
+
+    // Rejected frames: the roster in use stays
+    CHECK(RosterTest_Import(b, 20, 1, 0) == ROSTER_IMPORT_BAD_CRC);
+    RosterTest_Expect(a, 30);
+    CHECK(RosterTest_Import(b, 20, 2, 0) == ROSTER_IMPORT_UNSORTED);
+    RosterTest_Expect(a, 30);
+    RosterTest_Import(b, 20, 0, 10);
+    RosterTest_Expect(a, 30);
+    CHECK(RosterTest_Import(c, ROSTER_CAPACITY + 1, 0, 0) == ROSTER_IMPORT_FULL);
+    RosterTest_Expect(a, 30);
+
+    // Presence is kept by roster position and follows a new roster
+    unpackStudentID(a + 2 * ROSTERTEST_STRIDE, id);
+    CHECK(Store_Add(id, 1000) == STORE_OK);
+    CHECK(Roster_PresentCount() == 1 && Roster_IsPresent(2) && Roster_NextAbsent(2) == 3);
+    CHECK(Store_Add(id, 1001) == STORE_DUPLICATE);
+    CHECK(RosterTest_Import(a - ROSTERTEST_STRIDE, 10, 0, 0) == ROSTER_IMPORT_DONE);
+    CHECK(Roster_PresentCount() == 1 && Roster_IsPresent(3));
+    CHECK(RosterTest_Import(b, ROSTER_CAPACITY, 0, 0) == ROSTER_IMPORT_DONE);
+    RosterTest_Expect(b, ROSTER_CAPACITY);
+    CHECK(Roster_PresentCount() == 0);
+    CHECK(Store_Remove(id) == STORE_OK);
+
+    // Power cut anywhere in an import: the old roster or the new one
+    for (int32_t writes = 0; writes < 220; writes += 3) {
+        EESim_WritesLeft = writes;
+        RosterTest_Import(c, 25, 0, 0);
+        EEQueue_Flush();
+        if (EESim_IsCut()) {
+            EESim_PowerOn();
+            RosterTest_Boot();
+        }
+        EESim_WritesLeft = -1;
+        if (Roster_Count() == 25) {
+            RosterTest_Expect(c, 25);
+            news++;
+            CHECK(RosterTest_Import(b, ROSTER_CAPACITY, 0, 0) == ROSTER_IMPORT_DONE);
+        } else {
+            RosterTest_Expect(b, ROSTER_CAPACITY);
+            olds++;
+        }
+    }
+    CHECK(olds > 0 && news > 0);
+
+    // The bank sequence number wraps
+    for (uint16_t i = 0; i < 300; i++) {
+        CHECK(RosterTest_Import(i & 1 ? a : b, 10 + i % 20, 0, 0) == ROSTER_IMPORT_DONE);
+    }
+    RosterTest_Expect(a, 10 + 299 % 20);
+
+    CHECK(EESim_Stats.Misuse == 0);
+    printf("RosterTest: ok\n");
+    return 0;
+}
+
+// A roster frame of Count IDs fed as the command interface does. Damage
+// 1 flips a CRC bit, 2 swaps two IDs; Cut drops that many bytes from
+// the end and aborts, as the import timeout would.
+static RosterImport_t RosterTest_Import(const uint32_t Base, const uint16_t Count, const uint8_t Damage, const uint16_t Cut)
+{
+    uint8_t *frame = RosterTest_Frame;
+    RosterImport_t status = ROSTER_IMPORT_BUSY;
+    uint16_t length = 0, crc;
+
+    frame[length++] = FRAME_SOF0;
+    frame[length++] = FRAME_SOF1;
+    frame[length++] = FRAME_TYPE_ROSTER;
+    frame[length++] = ROSTER_SCHEMA_VERSION;
+    frame[length++] = Count & 0xFF;
+    frame[length++] = Count >> 8;
+    for (uint16_t i = 0; i < Count; i++) {
+        uint32_t packed = Base + (uint32_t)(Damage == 2 && i < 2 ? 1 - i : i) * ROSTERTEST_STRIDE;
+
+        memcpy(&frame[length], &packed, PACKED_ID_SIZE);
+        length += PACKED_ID_SIZE;
+    }
+    crc = Frame_Crc16(FRAME_CRC_INIT, &frame[2], length - 2) ^ (Damage == 1);
+    frame[length++] = crc & 0xFF;
+    frame[length++] = crc >> 8;
+
+    Roster_ImportBegin();
+    for (uint16_t i = 0; i < length - Cut && status == ROSTER_IMPORT_BUSY; i++) {
+        while (!Roster_ImportHasRoom()) status = Roster_ImportService();
+        Roster_ImportFeed(frame[i]);
+        status = Roster_ImportService();
+    }
+    if (Cut) {
+        Roster_ImportAbort();
+        return status;
+    }
+    while (status == ROSTER_IMPORT_BUSY) status = Roster_ImportService();
+    return status;
+}
+
+// In use now and after a reset
+static void RosterTest_Expect(const uint32_t Base, const uint16_t Count)
+{
+    for (uint8_t boot = 0; boot < 2; boot++) {
+        CHECK(Roster_Count() == Count);
+        for (uint16_t i = 0; i < Count; i++) {
+            CHECK(Roster_Get(i) == Base + i * ROSTERTEST_STRIDE);
+            CHECK(Roster_Find(Base + i * ROSTERTEST_STRIDE) == i);
+        }
+        CHECK(Roster_Find(Base + 1) < 0);
+        RosterTest_Boot();
+    }
+}
+
+static void RosterTest_Boot(void)
+{
+    EEQueue_Flush();
+    Store_Load();
+    Roster_Load();
+}
+//---------------------------//
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "I2CSim.h"
+#include "Session.h"
+
+// Session.h on the I2C backend, through I2CMem.h and the simulated
+// chip: archive enough sessions to wrap the header table, the record
+// area and the 8-bit IDs, reload after each one and compare often with a
+// model; then damage a record and expect Session_Verify() to notice
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+#define SESSIONTEST_SESSIONS    600
+
+typedef struct
+{
+    uint8_t Id;
+    uint8_t Count;
+    uint32_t Start;
+    uint32_t Packed[MAX_STUDENTS];
+    uint16_t Minute[MAX_STUDENTS];
+} SessionTestModel_t;
+
+static SessionTestModel_t SessionTest_Model[SESSION_SLOTS];   // Newest first
+static uint8_t SessionTest_Kept = 0;
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void SessionTest_Archive(const uint8_t Id);
+static void SessionTest_Compare(void);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    const Session_t *session;
+
+    I2CSim_Reset();
+    srand(7);
+    Session_Load(0);
+    CHECK(Session_Count() == 0);
+
+    for (uint16_t n = 0; n < SESSIONTEST_SESSIONS; n++) {
+        SessionTest_Archive(n & 0xFF);
+        Session_Load((n + 1) & 0xFF);
+        if (n % 8 == 0) SessionTest_Compare();
+    }
+    CHECK(SessionTest_Kept == SESSION_SLOTS);
+    CHECK(I2CSim_Stats.Overruns == 0);
+
+    // One flipped bit in the newest session's first record
+    session = Session_Get(0);
+    I2CSim_Memory[SESSION_DATA_ADDR + session->First * SESSION_RECORD_SIZE] ^= 0x01;
+    Session_Load(SESSIONTEST_SESSIONS & 0xFF);
+    CHECK(Session_Count() == SESSION_SLOTS);
+    CHECK(!Session_Verify(Session_Get(0)));
+    CHECK(Session_Verify(Session_Get(1)));
+
+    printf("SessionTest: ok\n");
+    return 0;
+}
+
+// A session of random size and contents, into the archive and the model
+static void SessionTest_Archive(const uint8_t Id)
+{
+    SessionTestModel_t *model;
+
+    if (SessionTest_Kept < SESSION_SLOTS) SessionTest_Kept++;
+    memmove(&SessionTest_Model[1], &SessionTest_Model[0], (SessionTest_Kept - 1) * sizeof(SessionTestModel_t));
+    model = &SessionTest_Model[0];
+    model->Id = Id;
+    model->Count = 1 + rand() % MAX_STUDENTS;
+    model->Start = (uint32_t)rand() * 60;
+
+    Session_Begin(model->Id, model->Start, model->Count);
+    for (uint8_t i = 0; i < model->Count; i++) {
+        model->Packed[i] = rand() & 0xFFFFFF;
+        model->Minute[i] = rand() % 1440;
+        Session_Append(i, model->Packed[i], model->Minute[i]);
+    }
+    Session_Commit();
+}
+
+// Everything the reloaded archive holds, read back from the chip
+static void SessionTest_Compare(void)
+{
+    CHECK(Session_Count() == SessionTest_Kept);
+    for (uint8_t n = 0; n < SessionTest_Kept; n++) {
+        const SessionTestModel_t *model = &SessionTest_Model[n];
+        const Session_t *session = Session_Get(n);
+
+        CHECK(session->Id == model->Id);
+        CHECK(session->Count == model->Count);
+        CHECK(session->Start == model->Start);
+        CHECK(Session_Find(model->Id)->Slot == Session_Get(n)->Slot);
+        session = Session_Get(n);
+        CHECK(Session_Verify(session));
+        for (uint8_t i = 0; i < model->Count; i++) {
+            uint32_t packed, timestamp;
+
+            Session_ReadRecord(session, i, &packed, &timestamp);
+            CHECK(packed == model->Packed[i]);
+            CHECK(timestamp == model->Start + model->Minute[i] * (uint32_t)STORE_TIME_STEP);
+        }
+    }
+}
+//---------------------------//
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EEQueue.h"
+#include "EESim.h"
+#include "Roster.h"
+#include "Session.h"
+#include "Store.h"
+
+// Store.h on the simulated EEPROM: random check-ins and removals
+// against a model, reloaded from the ring often, with power cuts in
+// the middle of changes; sync frames applied to a copy of the host's
+// list, with the list changing while they are sent; sessions closed;
+// and a v1 image converted on boot
+
+//----- Auxiliary data ------//
+#define CHECK(Cond)             do { if (!(Cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #Cond); exit(1); } } while (0)
+
+#define STORETEST_STEPS         4000
+#define STORETEST_IDS           60      // Distinct IDs, more than MAX_STUDENTS
+
+typedef struct
+{
+    uint32_t Packed[MAX_STUDENTS];
+    uint32_t Time[MAX_STUDENTS];
+    uint8_t Count;
+} StoreTestList_t;
+
+static StoreTestList_t StoreTest_Model;     // What the store must hold
+static StoreTestList_t StoreTest_Host;      // What the host has acknowledged
+static uint32_t StoreTest_Clock = 1000;
+static uint16_t StoreTest_Cuts = 0;         // Power cuts that hit a change
+static uint16_t StoreTest_Meddled = 0;      // Frames complete despite changes
+//---------------------------//
+
+//----- Prototypes ----------------------------//
+static void StoreTest_Boot(void);
+static void StoreTest_Change(const char *Id, const uint8_t Add);
+static void StoreTest_PowerCut(const char *Id, const uint8_t Add);
+static void StoreTest_Sync(const uint8_t Full, const uint8_t Meddle);
+static void StoreTest_Compare(void);
+static void StoreTest_Legacy(void);
+static void StoreTest_RandomId(char *Id);
+static int16_t StoreTest_Find(const StoreTestList_t *List, const uint32_t Packed);
+static void StoreTest_Put(StoreTestList_t *List, const uint32_t Packed, const uint32_t Time);
+static void StoreTest_Drop(StoreTestList_t *List, const uint32_t Packed);
+//---------------------------------------------//
+
+//----- Functions -------------//
+int main(void)
+{
+    char id[STUDENT_ID_LENGTH + 1];
+    uint8_t closed = 0;
+
+    EESim_Reset();
+    srand(11);
+    StoreTest_Boot();
+    EEQueue_Flush();
+    CHECK(Store_Count() == 0);
+    CHECK(EESim_Memory[EEPROM_START_ADDR] == STORE_MAGIC);
+
+    for (uint16_t step = 0; step < STORETEST_STEPS; step++) {
+        uint8_t op = rand() % 16;
+
+        StoreTest_Clock += rand() % 20;
+        StoreTest_RandomId(id);
+        if (op < 9) StoreTest_Change(id, 1);
+        else if (op < 13) StoreTest_Change(id, 0);
+        else if (op < 15) StoreTest_Sync(rand() % 8 == 0, rand() % 3 == 0);
+        else StoreTest_PowerCut(id, rand() % 2);
+
+        if (rand() % 4 == 0) Store_Service(rand() % 2);
+        if (rand() % 40 == 0) StoreTest_Boot();
+        // Archive now and then; the host is sent a snapshot afterwards
+        if (rand() % 300 == 0 && StoreTest_Model.Count) {
+            CHECK(Store_CloseSession() == STORE_OK);
+            CHECK(Session_Get(0)->Count == StoreTest_Model.Count);
+            StoreTest_Model.Count = 0;
+            closed++;
+        }
+        StoreTest_Compare();
+    }
+    CHECK(closed > 0 && StoreTest_Cuts > 0 && StoreTest_Meddled > 0);
+
+    StoreTest_Legacy();
+
+    CHECK(EESim_Stats.Misuse == 0);
+    printf("StoreTest: ok\n");
+    return 0;
+}
+
+// Reset: everything in RAM is rebuilt from the EEPROM
+static void StoreTest_Boot(void)
+{
+    EEQueue_Flush();
+    Store_Load();
+    Roster_Load();
+    StoreTest_Compare();
+}
+
+static void StoreTest_Change(const char *Id, const uint8_t Add)
+{
+    uint32_t packed = packStudentID(Id);
+    StoreStatus_t status;
+
+    if (Add) {
+        status = Store_Add(Id, StoreTest_Clock);
+        if (StoreTest_Find(&StoreTest_Model, packed) >= 0) CHECK(status == STORE_DUPLICATE);
+        else if (StoreTest_Model.Count == MAX_STUDENTS) CHECK(status == STORE_FULL);
+        else CHECK(status == STORE_OK);
+        if (status == STORE_OK) StoreTest_Put(&StoreTest_Model, packed, StoreTest_Clock);
+    } else {
+        status = Store_Remove(Id);
+        CHECK((status == STORE_OK) == (StoreTest_Find(&StoreTest_Model, packed) >= 0));
+        StoreTest_Drop(&StoreTest_Model, packed);
+    }
+}
+
+// The change with the power cut after a random number of EEPROM writes:
+// after the reset the store holds the list from before it or after it,
+// nothing in between
+static void StoreTest_PowerCut(const char *Id, const uint8_t Add)
+{
+    StoreTestList_t before = StoreTest_Model;
+    uint32_t packed = packStudentID(Id);
+    int16_t i;
+
+    EEQueue_Flush();
+    EESim_WritesLeft = rand() % 24;
+    StoreTest_Change(Id, Add);
+    EEQueue_Flush();
+    if (!EESim_IsCut()) {
+        EESim_WritesLeft = -1;
+        return;
+    }
+
+    StoreTest_Cuts++;
+    EESim_PowerOn();
+    Store_Load();
+    Roster_Load();
+    StoreTest_Drop(&StoreTest_Model, packed);
+    if (Store_Find(Id) >= 0) {
+        // Still there from before a lost removal, or a check-in now
+        i = StoreTest_Find(&before, packed);
+        StoreTest_Put(&StoreTest_Model, packed, i >= 0 ? before.Time[i] : StoreTest_Clock);
+    }
+}
+
+// One sync frame into a copy of the host's list, acknowledged half the
+// time. With Meddle, changes land between its records: a frame that is
+// not short must still bring the copy to the list as it was at Begin.
+static void StoreTest_Sync(const uint8_t Full, const uint8_t Meddle)
+{
+    StoreTestList_t copy = StoreTest_Host;
+    StoreTestList_t begin = StoreTest_Model;
+    StoreSync_t sync;
+    uint8_t record[SYNC_RECORD_SIZE];
+    uint16_t n = 0;
+
+    Store_SyncBegin(&sync, Full);
+    CHECK(sync.Full || !Full);
+    while (Store_SyncNext(&sync, record)) {
+        uint32_t packed = 0;
+
+        if (Meddle && rand() % 2) {
+            char id[STUDENT_ID_LENGTH + 1];
+
+            StoreTest_RandomId(id);
+            StoreTest_Change(id, rand() % 3 != 0);
+        }
+        n++;
+        if (sync.Short) continue;
+
+        memcpy(&packed, &record[3], PACKED_ID_SIZE);
+        if (n == 1) {
+            CHECK(record[0] == (sync.Full ? SYNC_KIND_SNAPSHOT : SYNC_KIND_DELTA));
+            if (record[0] == SYNC_KIND_SNAPSHOT) copy.Count = 0;
+        } else if (record[0] == SYNC_KIND_ADDED) {
+            if (StoreTest_Find(&copy, packed) < 0) StoreTest_Put(&copy, packed, 0);
+        } else {
+            CHECK(record[0] == SYNC_KIND_REMOVED);
+            StoreTest_Drop(&copy, packed);
+        }
+    }
+    CHECK(n == sync.Count);
+    CHECK(Meddle || !sync.Short);
+    if (sync.Short) return;
+    if (Meddle) StoreTest_Meddled++;
+
+    CHECK(copy.Count == begin.Count);
+    for (uint8_t i = 0; i < begin.Count; i++) CHECK(StoreTest_Find(&copy, begin.Packed[i]) >= 0);
+    if (rand() % 2) {
+        CHECK(Store_SyncAck(sync.Upto) == STORE_OK);
+        CHECK(Store_SyncCursor() == sync.Upto);
+        StoreTest_Host = copy;
+    }
+}
+
+// Same records, times to the step, and the ranges walk them in order
+static void StoreTest_Compare(void)
+{
+    StoreRange_t range;
+    uint32_t lastTime = 0, lastPacked = 0;
+    uint8_t n = 0;
+    int16_t index;
+
+    CHECK(Store_Count() == StoreTest_Model.Count);
+    for (uint8_t i = 0; i < StoreTest_Model.Count; i++) {
+        char id[STUDENT_ID_LENGTH + 1];
+        uint32_t time;
+
+        unpackStudentID(StoreTest_Model.Packed[i], id);
+        index = Store_Find(id);
+        CHECK(index >= 0);
+        time = Store_RecordTime(index);
+        CHECK(time <= StoreTest_Model.Time[i] && time + STORE_TIME_STEP > StoreTest_Model.Time[i]);
+    }
+
+    Store_RangeBegin(&range, 0, STORE_TIME_END);
+    CHECK(Store_RangeCount(&range) == StoreTest_Model.Count);
+    while ((index = Store_RangeNext(&range)) >= 0) {
+        uint32_t time = Store_RecordTime(index), packed = Store_RecordPacked(index);
+
+        CHECK(n == 0 || time > lastTime || (time == lastTime && packed > lastPacked));
+        lastTime = time;
+        lastPacked = packed;
+        n++;
+    }
+    CHECK(n == StoreTest_Model.Count);
+}
+
+// v1: count in the first byte, then ASCII ID and timestamp per record.
+// Valid records come over sorted by time, the bad one is dropped, and
+// the host's next sync is a snapshot.
+static void StoreTest_Legacy(void)
+{
+    static const char *ids[] = { "23101005", "2310100X", "23101002" };
+    static const uint32_t times[] = { 5000, 4000, 4600 };
+    StoreSync_t sync;
+    uint16_t addr = EEPROM_START_ADDR + 1;
+
+    // A v1 image written over a drained queue, as a flash update finds it
+    EEQueue_Flush();
+    EESim_Reset();
+    EESim_Memory[EEPROM_START_ADDR] = 3;
+    for (uint8_t i = 0; i < 3; i++) {
+        memcpy(&EESim_Memory[addr], ids[i], STUDENT_ID_LENGTH);
+        memcpy(&EESim_Memory[addr + STUDENT_ID_LENGTH], &times[i], sizeof(times[i]));
+        addr += STUDENT_ID_LENGTH + sizeof(times[i]);
+    }
+
+    StoreTest_Model.Count = 0;
+    StoreTest_Put(&StoreTest_Model, packStudentID(ids[0]), times[0]);
+    StoreTest_Put(&StoreTest_Model, packStudentID(ids[2]), times[2]);
+    for (uint8_t boot = 0; boot < 2; boot++) {
+        StoreTest_Boot();
+        EEQueue_Flush();
+        CHECK(EESim_Memory[EEPROM_START_ADDR] == STORE_MAGIC);
+        CHECK(Store_RecordPacked(0) == packStudentID(ids[2]));
+        CHECK(Store_RecordTime(0) == times[2]);
+    }
+    Store_SyncBegin(&sync, 0);
+    CHECK(sync.Full && sync.Count == 3);
+}
+
+static void StoreTest_RandomId(char *Id)
+{
+    sprintf(Id, "23101%03u", 1 + rand() % STORETEST_IDS);
+}
+
+static int16_t StoreTest_Find(const StoreTestList_t *List, const uint32_t Packed)
+{
+    for (uint8_t i = 0; i < List->Count; i++) {
+        if (List->Packed[i] == Packed) return i;
+    }
+    return -1;
+}
+
+static void StoreTest_Put(StoreTestList_t *List, const uint32_t Packed, const uint32_t Time)
+{
+    CHECK(List->Count < MAX_STUDENTS);
+    List->Packed[List->Count] = Packed;
+    List->Time[List->Count++] = Time;
+}
+
+static void StoreTest_Drop(StoreTestList_t *List, const uint32_t Packed)
+{
+    int16_t i = StoreTest_Find(List, Packed);
+
+    if (i < 0) return;
+    List->Count--;
+    List->Packed[i] = List->Packed[List->Count];
+    List->Time[i] = List->Time[List->Count];
+}
+//---------------------------//